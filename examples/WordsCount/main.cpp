@@ -3,6 +3,9 @@
 #include <vector>
 #include <fstream>
 #include <map>
+#include <unordered_map>
+#include <chrono>
+#include <thread>
 #include <algorithm>
 #include <sstream>
 #include <iterator>
@@ -15,31 +18,31 @@ using namespace std;
 int main()
 {
     auto ifs = shared_ptr<std::basic_istream<char>>(new std::ifstream(FILE_NAME));
+    using Counts = std::unordered_map<std::string, int>;
+    size_t rails = std::max(1u, std::thread::hardware_concurrency());
+    auto start = std::chrono::steady_clock::now();
 
+    //Every rail counts its lines into a map of its own; the maps are merged once
+    //the file has been read, so no lock is taken per word.
     auto values = Observable<>::from(ifs)
-            .concatMap([](const std::string& str) {
-        return Observable<std::string>::create([=](const Observable<std::string>::ThisSubscriberPtrType& t) {
-            std::istringstream iss(str);
-            std::for_each(std::istream_iterator<std::string>(iss), std::istream_iterator<std::string>(), [&](std::string s) {
-                s.erase(remove_if(s.begin(), s.end(), [](char c) { return !isalpha(c) && c != '\''; } ), s.end());
-                t->onNext(s);
-            });
-            t->onComplete();
-        }).subscribeOn(SchedulersFactory::instance().threadPoolScheduler());
-
-    })
-            .map([](const std::string& s) {
-        std::string res(s);
-        std::transform(res.begin(), res.end(), res.begin(), ::tolower);
-        return res;
+            .parallel(rails, SchedulersFactory::instance().threadPoolScheduler())
+            .collect([]() {
+        return Counts();
+    }, [](Counts& counts, const std::string& str) {
+        std::istringstream iss(str);
+        std::for_each(std::istream_iterator<std::string>(iss), std::istream_iterator<std::string>(), [&](std::string s) {
+            s.erase(remove_if(s.begin(), s.end(), [](char c) { return !isalpha(c) && c != '\''; } ), s.end());
+            std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+            ++counts[s];
+        });
+    }, [](Counts& into, const Counts& from) {
+        for(auto& entry : from)
+        {
+            into[entry.first] += entry.second;
+        }
     })
-            .synchronize()
-            .toMap([](const std::string& s) {
-        return s;
-    }, [](const std::string&) {
-        return 0;
-    }, [](const int&, const int& prev){
-        return prev + 1;
+            .map([](const Counts& counts) {
+        return std::map<std::string, int>(counts.begin(), counts.end());
     });
 
     values.subscribe([](const std::map<std::string, int>& str) {
@@ -54,8 +57,11 @@ int main()
                 std::rethrow_exception(eptr);
             }
         } catch(const std::exception& e) {cout << e.what();}
-    }, []() {
+    }, [=]() {
         std::cout << "\n============= complete ================\n";
+        std::cout << rails << " rails, "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()
+                  << " ms" << std::endl;
     });
 
     std::cin.get();
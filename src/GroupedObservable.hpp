@@ -0,0 +1,27 @@
+#ifndef GROUPEDOBSERVABLE_HPP
+#define GROUPEDOBSERVABLE_HPP
+
+#include "Observable.hpp"
+
+//The values of one key, as emitted by groupBy().
+template<typename K, typename T>
+class GroupedObservable : public Observable<T>
+{
+public:
+    using KeyType = K;
+
+    GroupedObservable() = default;
+
+    GroupedObservable(const K& key, const Observable<T>& source) : Observable<T>(source), key(key)
+    {}
+
+    const K& getKey() const
+    {
+        return key;
+    }
+
+private:
+    K key;
+};
+
+#endif // GROUPEDOBSERVABLE_HPP
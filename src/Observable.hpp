@@ -5,6 +5,7 @@
 #include "Subscriber.hpp"
 #include "operators/OperatorFilter.hpp"
 #include "operators/OperatorMap.hpp"
+#include "operators/OperatorMapAsync.hpp"
 #include "operators/OperatorDistinct.hpp"
 #include "operators/OperatorAll.hpp"
 #include "operators/OperatorExist.hpp"
@@ -13,27 +14,53 @@
 #include "operators/OperatorTake.hpp"
 #include "operators/OperatorTakeWhile.hpp"
 #include "operators/OperatorObserveOn.hpp"
+#include "operators/OperatorObserveOnBatched.hpp"
+#include "operators/OperatorObserveOnPartitioned.hpp"
 #include "operators/OperatorToMap.hpp"
+#include "operators/OperatorToMapIncremental.hpp"
+#include "operators/OperatorReduceConcurrent.hpp"
+#include "operators/OperatorBuffer.hpp"
+#include "operators/OperatorWindow.hpp"
+#include "operators/OperatorThrottleFirst.hpp"
+#include "operators/OperatorSample.hpp"
+#include "operators/OperatorDebounce.hpp"
+#include "operators/OperatorGroupBy.hpp"
 #include "operators/OperatorDoOnEach.hpp"
 #include "operators/LiftOnSubscribe.hpp"
 #include "operators/OperatorSubscribeOn.hpp"
 #include "operators/DeferOnSubscribe.hpp"
 #include "operators/RangeOnSubscribe.hpp"
+#include "operators/JustOnSubscribe.hpp"
+#include "operators/FromListOnSubscribe.hpp"
 #include "operators/RepeatOnSubscribe.hpp"
+#include "operators/OnSubscribeTimeout.hpp"
+#include "operators/OnSubscribeRetry.hpp"
+#include "operators/OnSubscribeAmb.hpp"
+#include "operators/OnSubscribeZip.hpp"
+#include "operators/OnSubscribeCombineLatest.hpp"
 #include "operators/OnSubscribeConcatMap.hpp"
+#include "operators/OnSubscribeConcatMapEager.hpp"
 #include "operators/OnSubscribeFlatMap.hpp"
+#include "operators/OnSubscribeSwitchMap.hpp"
 #include "operators/OnSubscribePeriodically.hpp"
 #include "operators/OperatorSynchronize.hpp"
+#include "operators/OperatorSerialize.hpp"
+#include "operators/OperatorStage.hpp"
 #include "SchedulersFactory.hpp"
 #include "utils/Util.hpp"
+#include "utils/ThreadPoolExecutor.hpp"
 #include <memory>
 #include <initializer_list>
 #include <array>
+#include <vector>
 
 
 template<typename T>
 using OnSubscribePtrType = std::shared_ptr<OnSubscribeBase<T>>;
 
+template<typename T>
+class ParallelObservable;
+
 template<typename T = void>
 class Observable
 {
@@ -125,6 +152,38 @@ public:
                     this->onSubscribe);
     }
 
+    Observable<T> observeOn(const Scheduler::SchedulerRefType& scheduler, Priority priority)
+    {
+        return observeOn(scheduler, std::numeric_limits<size_t>::max(), priority);
+    }
+
+    Observable<T> observeOn(const Scheduler::SchedulerRefType& scheduler, size_t bufferSize, Priority priority)
+    {
+        return lift(std::unique_ptr<Operator<T, T>>(make_unique<OperatorObserveOn<T>>(scheduler, bufferSize, priority)),
+                    this->onSubscribe);
+    }
+
+    //Hands values over in batches of up to batchSize, a partial batch leaves once
+    //linger has passed since its first value.
+    template<typename Rep, typename Period>
+    Observable<T> observeOn(const Scheduler::SchedulerRefType& scheduler, size_t batchSize,
+                            const std::chrono::duration<Rep, Period>& linger, Priority priority = Priority::Normal)
+    {
+        return lift(std::unique_ptr<Operator<T, T>>(make_unique<OperatorObserveOnBatched<T>>(scheduler, batchSize,
+                                                                                             linger, priority)));
+    }
+
+    //Values with equal keys are observed serially on the same partition thread.
+    //Only viable for selectors callable with a value, other arguments pick the overloads above.
+    template<typename KeySelector>
+    typename std::conditional<true, Observable<T>,
+                              typename std::result_of<typename std::decay<KeySelector>::type&(const T&)>::type>::type
+    observeOn(const std::shared_ptr<PartitionedScheduler>& scheduler, KeySelector&& keySelector)
+    {
+        return lift(std::unique_ptr<Operator<T, T>>(make_unique<OperatorObserveOnPartitioned<T, KeySelector>>(
+                        scheduler, std::forward<KeySelector>(keySelector))));
+    }
+
     template<typename R, typename P>
     Observable<P> lift(std::unique_ptr<Operator<R, P>>&& o, std::shared_ptr<OnSubscribeBase<R>> onSubs)
     {
@@ -207,6 +266,17 @@ public:
                     (make_unique<OperatorMap<T, Mapper>>(std::forward<Mapper>(fun))));
     }
 
+    //Maps on the scheduler with up to maxInFlight values in progress, keeping
+    //the order of the values. The mapper has to be safe to call concurrently.
+    template<typename Mapper>
+    Observable<typename std::result_of<Mapper(const T&)>::type> mapAsync(Mapper&& fun,
+                                                                        const Scheduler::SchedulerRefType& scheduler,
+                                                                        size_t maxInFlight)
+    {
+        return lift(std::unique_ptr<Operator<T, typename std::result_of<Mapper(const T&)>::type>>
+                    (make_unique<OperatorMapAsync<T, Mapper>>(std::forward<Mapper>(fun), scheduler, maxInFlight)));
+    }
+
     template<typename KeySelector, typename ValueSelector, typename ValuePrevSelector>
     Observable<MapT<T,KeySelector,ValueSelector>>
     toMap(KeySelector&& keySelector, ValueSelector&& valueSelector, ValuePrevSelector&& vpSelector)
@@ -218,6 +288,22 @@ public:
                                                           std::forward<ValuePrevSelector>(vpSelector))));
     }
 
+    //toMap for a source emitting from several threads at once: each thread fills
+    //a map of its own, and values of a key from different threads are merged with
+    //combiner(value, value) on completion.
+    template<typename KeySelector, typename ValueSelector, typename ValuePrevSelector, typename Combiner>
+    Observable<MapT<T,KeySelector,ValueSelector>>
+    toMapConcurrent(KeySelector&& keySelector, ValueSelector&& valueSelector, ValuePrevSelector&& vpSelector,
+                    Combiner&& combiner)
+    {
+        return lift(std::unique_ptr<Operator<T,MapT<T,KeySelector,ValueSelector>>>(
+                   make_unique<OperatorToMapConcurrent<T, KeySelector, ValueSelector, ValuePrevSelector, Combiner>>(
+                                                          std::forward<KeySelector>(keySelector),
+                                                          std::forward<ValueSelector>(valueSelector),
+                                                          std::forward<ValuePrevSelector>(vpSelector),
+                                                          std::forward<Combiner>(combiner))));
+    }
+
     template<typename KeySelector, typename ValueSelector>
     Observable<MapT<T,KeySelector,ValueSelector>> toMap(KeySelector&& keySelector, ValueSelector&& valueSelector)
     {
@@ -233,6 +319,69 @@ public:
                      [](const T& t){return t;}, [](const T& t,const T&){return t;});
     }
 
+    //toMap into a map type of the caller's choice, e.g. toMapAs<std::unordered_map<K,V>>(...);
+    //expectedSize pre-sizes hash maps.
+    template<typename MapType, typename KeySelector, typename ValueSelector, typename ValuePrevSelector>
+    Observable<MapType> toMapAs(KeySelector&& keySelector, ValueSelector&& valueSelector,
+                                ValuePrevSelector&& vpSelector, size_t expectedSize = 0)
+    {
+        return lift(std::unique_ptr<Operator<T, MapType>>(
+                   make_unique<OperatorToMap<T, KeySelector, ValueSelector, ValuePrevSelector, MapType>>(
+                                                          std::forward<KeySelector>(keySelector),
+                                                          std::forward<ValueSelector>(valueSelector),
+                                                          std::forward<ValuePrevSelector>(vpSelector),
+                                                          expectedSize)));
+    }
+
+    template<typename KeySelector, typename ValueSelector, typename ValuePrevSelector,
+             typename = typename std::enable_if<!std::is_integral<
+                                                typename std::decay<ValuePrevSelector>::type>::value>::type>
+    Observable<UnorderedMapT<T,KeySelector,ValueSelector>>
+    toUnorderedMap(KeySelector&& keySelector, ValueSelector&& valueSelector, ValuePrevSelector&& vpSelector,
+                   size_t expectedSize = 0)
+    {
+        return toMapAs<UnorderedMapT<T,KeySelector,ValueSelector>>(std::forward<KeySelector>(keySelector),
+                                                                   std::forward<ValueSelector>(valueSelector),
+                                                                   std::forward<ValuePrevSelector>(vpSelector),
+                                                                   expectedSize);
+    }
+
+    template<typename KeySelector, typename ValueSelector>
+    Observable<UnorderedMapT<T,KeySelector,ValueSelector>>
+    toUnorderedMap(KeySelector&& keySelector, ValueSelector&& valueSelector, size_t expectedSize = 0)
+    {
+        return toUnorderedMap(std::forward<KeySelector>(keySelector), std::forward<ValueSelector>(valueSelector),
+                              [](const typename std::result_of<ValueSelector(const T&)>::type& t,
+                              typename std::result_of<ValueSelector(const T&)>::type){return t;},
+                              expectedSize);
+    }
+
+    //toMap for endless streams: emits (key, new value) for every value. The
+    //state is kept in view, or in a private one, for snapshots at any time.
+    template<typename KeySelector, typename ValueSelector, typename ValuePrevSelector>
+    Observable<typename OperatorToMapIncremental<T, KeySelector, ValueSelector, ValuePrevSelector>::UpdateType>
+    toMapIncremental(KeySelector&& keySelector, ValueSelector&& valueSelector, ValuePrevSelector&& vpSelector,
+                     const typename ToMapIncrementalTypes<T, KeySelector, ValueSelector>::ViewRefType& view = nullptr)
+    {
+        using OperatorType = OperatorToMapIncremental<T, KeySelector, ValueSelector, ValuePrevSelector>;
+        return lift(std::unique_ptr<Operator<T, typename OperatorType::UpdateType>>(
+                        make_unique<OperatorType>(keySelector, valueSelector, vpSelector, view)));
+    }
+
+    //As above, but the keys changed within a period leave as one batch, each
+    //with its latest value.
+    template<typename KeySelector, typename ValueSelector, typename ValuePrevSelector, typename Rep, typename Period>
+    Observable<typename OperatorToMapIncrementalBatched<T, KeySelector, ValueSelector, ValuePrevSelector>::BatchType>
+    toMapIncremental(KeySelector&& keySelector, ValueSelector&& valueSelector, ValuePrevSelector&& vpSelector,
+                     const std::chrono::duration<Rep, Period>& period,
+                     const typename ToMapIncrementalTypes<T, KeySelector, ValueSelector>::ViewRefType& view = nullptr,
+                     const Scheduler::SchedulerRefType& scheduler = SchedulersFactory::instance().threadPoolScheduler())
+    {
+        using OperatorType = OperatorToMapIncrementalBatched<T, KeySelector, ValueSelector, ValuePrevSelector>;
+        return lift(std::unique_ptr<Operator<T, typename OperatorType::BatchType>>(
+                        make_unique<OperatorType>(keySelector, valueSelector, vpSelector, period, view, scheduler)));
+    }
+
     template<typename Predicate>
     Observable<bool> all(Predicate&& pred)
     {
@@ -274,6 +423,132 @@ public:
         return scan(std::forward<Accumulator>(accumulator)).last();
     }
 
+    //reduce for a source emitting from several threads at once. The accumulator
+    //has to be associative and commutative.
+    template<typename Accumulator>
+    Observable<T> reduceConcurrent(Accumulator&& accumulator)
+    {
+        return lift(std::unique_ptr<Operator<T, T>>(
+                        make_unique<OperatorReduceConcurrent<T, Accumulator>>(std::forward<Accumulator>(accumulator))));
+    }
+
+    //Vectors of count values, a new one started every skip values.
+    Observable<std::vector<T>> buffer(size_t count, size_t skip)
+    {
+        return lift(std::unique_ptr<Operator<T, std::vector<T>>>(make_unique<OperatorBuffer<T>>(count, skip)));
+    }
+
+    Observable<std::vector<T>> buffer(size_t count)
+    {
+        return buffer(count, count);
+    }
+
+    //Vectors whose values' sizes, as given by sizeOf, add up to at most maxSize.
+    template<typename SizeFunction>
+    Observable<std::vector<T>> bufferBySize(size_t maxSize, SizeFunction&& sizeOf)
+    {
+        return lift(std::unique_ptr<Operator<T, std::vector<T>>>(
+                        make_unique<OperatorBufferBySize<T, SizeFunction>>(maxSize, std::forward<SizeFunction>(sizeOf))));
+    }
+
+    //Vectors emitted timespan after their first value or once they hold maxCount
+    //values, whichever comes first.
+    template<typename Rep, typename Period>
+    Observable<std::vector<T>> buffer(const std::chrono::duration<Rep, Period>& timespan,
+                                      size_t maxCount = std::numeric_limits<size_t>::max(),
+                                      const Scheduler::SchedulerRefType& scheduler =
+                                          SchedulersFactory::instance().threadPoolScheduler())
+    {
+        return lift(std::unique_ptr<Operator<T, std::vector<T>>>(
+                        make_unique<OperatorBufferWithTime<T>>(timespan, maxCount, scheduler)));
+    }
+
+    //Consecutive windows of count values, each one an Observable subscribable once.
+    Observable<Observable<T>> window(size_t count)
+    {
+        return lift(std::unique_ptr<Operator<T, Observable<T>>>(make_unique<OperatorWindow<T>>(count)));
+    }
+
+    //Windows closing timespan after their first value.
+    template<typename Rep, typename Period>
+    Observable<Observable<T>> window(const std::chrono::duration<Rep, Period>& timespan,
+                                     const Scheduler::SchedulerRefType& scheduler =
+                                         SchedulersFactory::instance().threadPoolScheduler())
+    {
+        return lift(std::unique_ptr<Operator<T, Observable<T>>>(
+                        make_unique<OperatorWindowWithTime<T>>(timespan, scheduler)));
+    }
+
+    //Emits a value, then drops values for window.
+    template<typename Rep, typename Period>
+    Observable<T> throttleFirst(const std::chrono::duration<Rep, Period>& window,
+                                const Scheduler::SchedulerRefType& scheduler =
+                                    SchedulersFactory::instance().threadPoolScheduler())
+    {
+        return lift(std::unique_ptr<Operator<T, T>>(make_unique<OperatorThrottleFirst<T>>(window, scheduler)));
+    }
+
+    //Emits the latest value every period, when one arrived since the last tick.
+    template<typename Rep, typename Period>
+    Observable<T> sample(const std::chrono::duration<Rep, Period>& period,
+                         const Scheduler::SchedulerRefType& scheduler =
+                             SchedulersFactory::instance().threadPoolScheduler())
+    {
+        return lift(std::unique_ptr<Operator<T, T>>(make_unique<OperatorSample<T>>(period, scheduler)));
+    }
+
+    template<typename Rep, typename Period>
+    Observable<T> throttleLast(const std::chrono::duration<Rep, Period>& period,
+                               const Scheduler::SchedulerRefType& scheduler =
+                                   SchedulersFactory::instance().threadPoolScheduler())
+    {
+        return sample(period, scheduler);
+    }
+
+    //Emits a value once no newer one arrived for quiet.
+    template<typename Rep, typename Period>
+    Observable<T> debounce(const std::chrono::duration<Rep, Period>& quiet,
+                           const Scheduler::SchedulerRefType& scheduler =
+                               SchedulersFactory::instance().threadPoolScheduler())
+    {
+        return lift(std::unique_ptr<Operator<T, T>>(make_unique<OperatorDebounce<T>>(quiet, scheduler)));
+    }
+
+    //Splits the stream into one GroupedObservable per key.
+    template<typename KeySelector>
+    Observable<typename OperatorGroupBy<T, typename std::decay<KeySelector>::type>::GroupType>
+    groupBy(KeySelector&& keySelector)
+    {
+        return groupBy(std::forward<KeySelector>(keySelector), nullptr, std::chrono::steady_clock::duration::zero());
+    }
+
+    //Groups without a value for idle are completed and forgotten.
+    template<typename KeySelector, typename Rep, typename Period>
+    Observable<typename OperatorGroupBy<T, typename std::decay<KeySelector>::type>::GroupType>
+    groupBy(KeySelector&& keySelector, const std::chrono::duration<Rep, Period>& idle)
+    {
+        return groupBy(std::forward<KeySelector>(keySelector), nullptr, idle);
+    }
+
+    //Every group is observed on the worker the scheduler pins to its key.
+    template<typename KeySelector>
+    Observable<typename OperatorGroupBy<T, typename std::decay<KeySelector>::type>::GroupType>
+    groupBy(KeySelector&& keySelector, const Scheduler::SchedulerRefType& scheduler)
+    {
+        return groupBy(std::forward<KeySelector>(keySelector), scheduler, std::chrono::steady_clock::duration::zero());
+    }
+
+    template<typename KeySelector, typename Rep, typename Period>
+    Observable<typename OperatorGroupBy<T, typename std::decay<KeySelector>::type>::GroupType>
+    groupBy(KeySelector&& keySelector, const Scheduler::SchedulerRefType& scheduler,
+            const std::chrono::duration<Rep, Period>& idle)
+    {
+        typedef OperatorGroupBy<T, typename std::decay<KeySelector>::type> GroupByType;
+        return lift(std::unique_ptr<Operator<T, typename GroupByType::GroupType>>(
+                        make_unique<GroupByType>(std::forward<KeySelector>(keySelector), scheduler,
+                                                 std::chrono::duration_cast<std::chrono::steady_clock::duration>(idle))));
+    }
+
     template<typename Mapper>
     typename std::result_of<Mapper(const T&)>::type concatMap(Mapper&& mapper)
     {
@@ -282,6 +557,20 @@ public:
         return create<Type>(std::make_shared<OnSubscribeConcatMap<T, Type, Mapper>>(this->onSubscribe, std::forward<Mapper>(mapper)));
     }
 
+    //Subscribes up to maxConcurrency inner observables at once and emits their
+    //values in source order, buffering at most prefetch values per inner.
+    template<typename Mapper>
+    typename std::result_of<Mapper(const T&)>::type concatMapEager(Mapper&& mapper,
+                                                                   size_t maxConcurrency = std::numeric_limits<size_t>::max(),
+                                                                   size_t prefetch = std::numeric_limits<size_t>::max())
+    {
+        typedef decltype(mapper(T())) ObservableType;
+        typedef typename ObservableType::ValueType Type;
+        return create<Type>(std::make_shared<OnSubscribeConcatMapEager<T, Type, Mapper>>(this->onSubscribe,
+                                                                                         std::forward<Mapper>(mapper),
+                                                                                         maxConcurrency, prefetch));
+    }
+
     template<typename Mapper>
     typename std::result_of<Mapper(const T&)>::type flatMap(Mapper&& mapper)
     {
@@ -290,11 +579,75 @@ public:
          return create<Type>(std::make_shared<OnSubscribeFlatMap<T, Type, Mapper>>(this->onSubscribe, std::forward<Mapper>(mapper)));
     }
 
+    //Keeps at most maxConcurrency inner observables subscribed at a time.
+    template<typename Mapper>
+    typename std::result_of<Mapper(const T&)>::type flatMap(Mapper&& mapper, size_t maxConcurrency)
+    {
+         typedef decltype(mapper(T())) ObservableType;
+         typedef typename ObservableType::ValueType Type;
+         return create<Type>(std::make_shared<OnSubscribeFlatMap<T, Type, Mapper>>(this->onSubscribe,
+                                                                                  std::forward<Mapper>(mapper),
+                                                                                  maxConcurrency));
+    }
+
+    //Mirrors only the observable mapped from the latest value, unsubscribing the previous one.
+    template<typename Mapper>
+    typename std::result_of<Mapper(const T&)>::type switchMap(Mapper&& mapper)
+    {
+         typedef decltype(mapper(T())) ObservableType;
+         typedef typename ObservableType::ValueType Type;
+         return create<Type>(std::make_shared<OnSubscribeSwitchMap<T, Type, Mapper>>(this->onSubscribe,
+                                                                                    std::forward<Mapper>(mapper)));
+    }
+
     Observable<T> repeat(size_t count = 0)
     {
         return create<T>(std::make_shared<RepeatOnSubscribe<T>>(this->onSubscribe, count));
     }
 
+    //Fails with TimeoutException when no value arrives within timeout.
+    template<typename Rep, typename Period>
+    Observable<T> timeout(const std::chrono::duration<Rep, Period>& timeout,
+                          const Scheduler::SchedulerRefType& scheduler =
+                              SchedulersFactory::instance().threadPoolScheduler())
+    {
+        return create<T>(std::make_shared<OnSubscribeTimeout<T>>(this->onSubscribe, timeout, scheduler));
+    }
+
+    //Switches to fallback when no value arrives within timeout.
+    template<typename Rep, typename Period>
+    Observable<T> timeout(const std::chrono::duration<Rep, Period>& timeout, const Observable<T>& fallback,
+                          const Scheduler::SchedulerRefType& scheduler =
+                              SchedulersFactory::instance().threadPoolScheduler())
+    {
+        return create<T>(std::make_shared<OnSubscribeTimeout<T>>(this->onSubscribe, timeout, scheduler,
+                                                                 fallback.onSubscribe));
+    }
+
+    //Resubscribes after an error once the delay returned by handler(error, attempt)
+    //has passed; a negative delay gives up.
+    template<typename Handler>
+    Observable<T> retryWhen(Handler&& handler,
+                            const Scheduler::SchedulerRefType& scheduler =
+                                SchedulersFactory::instance().threadPoolScheduler())
+    {
+        return create<T>(std::make_shared<OnSubscribeRetry<T, Handler>>(this->onSubscribe,
+                                                                        std::forward<Handler>(handler),
+                                                                        scheduler));
+    }
+
+    //Up to maxRetries resubscriptions with exponential backoff.
+    template<typename Rep, typename Period>
+    Observable<T> retry(size_t maxRetries, const std::chrono::duration<Rep, Period>& initialDelay,
+                        double multiplier = 2.0, double jitter = 0.0,
+                        const Scheduler::SchedulerRefType& scheduler =
+                            SchedulersFactory::instance().threadPoolScheduler())
+    {
+        return retryWhen(ExponentialBackoff(maxRetries,
+                                            std::chrono::duration_cast<std::chrono::steady_clock::duration>(initialDelay),
+                                            multiplier, jitter), scheduler);
+    }
+
     template<typename L>
     Observable<T> synchronize(L lock)
     {
@@ -306,6 +659,47 @@ public:
        return lift(std::unique_ptr<Operator<T, T>>(make_unique<OperatorSynchronize<T,std::mutex>>()));
     }
 
+    //Runs the rest of the chain on the scheduler's worker behind a bounded queue
+    //holding at most capacity values; a full queue blocks the upstream. Counters of the
+    //boundary are collected into stats when it is given.
+    Observable<T> stage(const Scheduler::SchedulerRefType& scheduler, size_t capacity,
+                        const StageStatsPtrType& stats = nullptr)
+    {
+        return lift(std::unique_ptr<Operator<T, T>>(make_unique<OperatorStage<T>>(scheduler, capacity, stats)));
+    }
+
+    //Lock-free alternative to synchronize(): concurrent callers never wait for each other.
+    Observable<T> serialize()
+    {
+       return lift(std::unique_ptr<Operator<T, T>>(make_unique<OperatorSerialize<T>>()));
+    }
+
+    //Splits the stream round-robin onto rails processed in parallel on the scheduler.
+    ParallelObservable<T> parallel(size_t rails, const Scheduler::SchedulerRefType& scheduler);
+
+    //Values with equal keys go to the same rail.
+    template<typename KeySelector>
+    ParallelObservable<T> parallel(size_t rails, const Scheduler::SchedulerRefType& scheduler,
+                                   KeySelector&& keySelector);
+
+    ParallelObservable<T> parallel(size_t rails)
+    {
+        return parallel(rails, SchedulersFactory::instance().threadPoolScheduler());
+    }
+
+    //True when subscribing emits every value inline and then completes: range,
+    //just, from and map/filter chains over them.
+    bool isSynchronous() const
+    {
+        return onSubscribe != nullptr && onSubscribe->isSynchronous();
+    }
+
+    //Pulls the values of a synchronous observable without subscribing.
+    void drainSync(const SyncConsumer<T>& consumer)
+    {
+        onSubscribe->drainSync(consumer);
+    }
+
 protected:
     template<typename B>
     static SubscriptionPtrType subscribe(SubscriberPtrType<B> subscriber,
@@ -319,6 +713,8 @@ protected:
     }
 
 private:
+    template<typename> friend class Observable;
+
     ThisOnSubscribePtrType onSubscribe;
     ThisSubscriberPtrType createSubscriber(
             typename ThisSubscriberType::ThisOnNextFP next,
@@ -329,6 +725,14 @@ private:
     }
 };
 
+template<typename T>
+struct is_observable : std::false_type
+{};
+
+template<typename T>
+struct is_observable<Observable<T>> : std::true_type
+{};
+
 template<>
 class Observable<void>
 {
@@ -378,7 +782,10 @@ public:
             }
 
             StringType line;
-            while (std::getline(*is, line))
+            auto readLine = [&]() -> bool {
+                return static_cast<bool>(std::getline(*is, line));
+            };
+            while (blocking(readLine))
             {
                 subscriber->onNext(line);
                 if(!(*is).good())
@@ -394,12 +801,7 @@ public:
     template<typename T>
     static Observable<T> just(T value)
     {
-        return Observable<T>::create([value](const typename Observable<T>::
-                                     ThisSubscriberPtrType& subscriber)
-        {
-            subscriber->onNext(value);
-            subscriber->onComplete();
-        });
+        return create<T>(std::make_shared<JustOnSubscribe<T>>(std::move(value)));
     }
 
     template<typename T>
@@ -541,6 +943,82 @@ public:
         return merge(o);
     }
 
+    //Tuples of the n-th values of every source.
+    template<typename T, typename ...R>
+    static Observable<std::tuple<T, R...>> zip(const Observable<T>& a, const Observable<R>& ...args)
+    {
+        return zip(MakeTuple(), a, args...);
+    }
+
+    //The n-th values of every source passed to combiner.
+    template<typename Combiner, typename T, typename ...R,
+             typename = typename std::enable_if<!is_observable<typename std::decay<Combiner>::type>::value>::type>
+    static auto zip(Combiner&& combiner, const Observable<T>& a, const Observable<R>& ...args) ->
+    Observable<typename std::result_of<typename std::decay<Combiner>::type(const T&, const R&...)>::type>
+    {
+        return zip(std::numeric_limits<size_t>::max(), std::forward<Combiner>(combiner), a, args...);
+    }
+
+    //Fails with SlowSubscriberException once a source is more than bufferSize
+    //values ahead of the others.
+    template<typename Combiner, typename T, typename ...R>
+    static auto zip(size_t bufferSize, Combiner&& combiner, const Observable<T>& a, const Observable<R>& ...args) ->
+    Observable<typename std::result_of<typename std::decay<Combiner>::type(const T&, const R&...)>::type>
+    {
+        typedef typename std::result_of<typename std::decay<Combiner>::type(const T&, const R&...)>::type Type;
+        return create<Type>(std::make_shared<OnSubscribeZip<Type, Combiner, T, R...>>(
+                                std::forward<Combiner>(combiner), std::make_tuple(a.onSubscribe, args.onSubscribe...),
+                                bufferSize));
+    }
+
+    //Tuples of the latest values, each time any source emits.
+    template<typename T, typename ...R>
+    static Observable<std::tuple<T, R...>> combineLatest(const Observable<T>& a, const Observable<R>& ...args)
+    {
+        return combineLatest(MakeTuple(), a, args...);
+    }
+
+    template<typename Combiner, typename T, typename ...R,
+             typename = typename std::enable_if<!is_observable<typename std::decay<Combiner>::type>::value>::type>
+    static auto combineLatest(Combiner&& combiner, const Observable<T>& a, const Observable<R>& ...args) ->
+    Observable<typename std::result_of<typename std::decay<Combiner>::type(const T&, const R&...)>::type>
+    {
+        return combineLatest(std::numeric_limits<size_t>::max(), std::forward<Combiner>(combiner), a, args...);
+    }
+
+    //Fails with SlowSubscriberException once a source queues more than
+    //bufferSize values while the combined ones are being emitted.
+    template<typename Combiner, typename T, typename ...R>
+    static auto combineLatest(size_t bufferSize, Combiner&& combiner, const Observable<T>& a,
+                              const Observable<R>& ...args) ->
+    Observable<typename std::result_of<typename std::decay<Combiner>::type(const T&, const R&...)>::type>
+    {
+        typedef typename std::result_of<typename std::decay<Combiner>::type(const T&, const R&...)>::type Type;
+        return create<Type>(std::make_shared<OnSubscribeCombineLatest<Type, Combiner, T, R...>>(
+                                std::forward<Combiner>(combiner), std::make_tuple(a.onSubscribe, args.onSubscribe...),
+                                bufferSize));
+    }
+
+    //Mirrors whichever source signals first; the others are unsubscribed.
+    template<typename T, typename ...R>
+    static Observable<T> amb(const Observable<T>& a, const Observable<R>& ...args)
+    {
+        std::vector<ThisOnSubscribePtrType<T>> sources = {a.onSubscribe, args.onSubscribe...};
+        return create<T>(std::make_shared<OnSubscribeAmb<T>>(std::move(sources)));
+    }
+
+    //Subscribes source once more, up to copies times, each after a further delay
+    //without any signal, and mirrors the first copy to answer.
+    template<typename T, typename Rep, typename Period>
+    static Observable<T> hedge(const Observable<T>& source, const std::chrono::duration<Rep, Period>& delay,
+                               size_t copies = 1,
+                               const Scheduler::SchedulerRefType& scheduler =
+                                   SchedulersFactory::instance().threadPoolScheduler())
+    {
+        std::vector<ThisOnSubscribePtrType<T>> sources(copies + 1, source.onSubscribe);
+        return create<T>(std::make_shared<OnSubscribeAmb<T>>(std::move(sources), delay, scheduler));
+    }
+
 private:
     template<typename T, typename L>
     static Observable<T> fromList(const L& list)
@@ -548,19 +1026,11 @@ private:
         static_assert((std::is_array<L>::value ||
                        is_iterable<L>::value), "Array type is required.");
 
-        return Observable<T>::create([list](const typename Observable<T>::
-                                     ThisSubscriberPtrType& subscriber)
-        {
-            auto value = std::begin(list);
-            auto end = std::end(list);
-            while(value != end)
-            {
-                subscriber->onNext(*value);
-                ++value;
-            }
-            subscriber->onComplete();
-        });
+        return create<T>(std::make_shared<FromListOnSubscribe<T>>(list));
     }
 };
 
+#include "ParallelObservable.hpp"
+#include "GroupedObservable.hpp"
+
 #endif // OBSERVABLE_H
@@ -0,0 +1,111 @@
+#ifndef PARALLELOBSERVABLE_HPP
+#define PARALLELOBSERVABLE_HPP
+
+#include "Observable.hpp"
+#include "operators/OnSubscribeParallel.hpp"
+
+//A stream split onto rails that run on scheduler workers in parallel. Every
+//rail sees its values serially; sequential() or reduce() merge the rails back
+//into an Observable.
+template<typename T>
+class ParallelObservable
+{
+public:
+    using ParallelOnSubscribePtrType = std::shared_ptr<ParallelOnSubscribeBase<T>>;
+    using ValueType = T;
+
+    ParallelObservable(ParallelOnSubscribePtrType f) : onSubscribe(std::move(f))
+    {}
+
+    size_t rails() const
+    {
+        return onSubscribe->rails();
+    }
+
+    template<typename Mapper>
+    ParallelObservable<typename std::result_of<Mapper(const T&)>::type> map(Mapper&& fun)
+    {
+        typedef typename std::result_of<Mapper(const T&)>::type R;
+        typename std::decay<Mapper>::type mapper(std::forward<Mapper>(fun));
+        return lift<R>([mapper](const Sequenced<T>& t){
+            return t.valid ? Sequenced<R>(t.index, mapper(t.value)) : Sequenced<R>(t.index);
+        });
+    }
+
+    template<typename Predicate>
+    ParallelObservable<T> filter(Predicate&& pred)
+    {
+        static_assert(std::is_same<typename std::result_of<Predicate(const T&)>::type, bool>::value,
+                      "Predicate(T&) must return a bool value");
+        typename std::decay<Predicate>::type predicate(std::forward<Predicate>(pred));
+        return lift<T>([predicate](const Sequenced<T>& t){
+            return t.valid && predicate(t.value) ? t : Sequenced<T>(t.index);
+        });
+    }
+
+    //Reduces each rail in parallel and then the rails' results. The accumulator
+    //has to be associative and commutative.
+    template<typename Accumulator>
+    Observable<T> reduce(Accumulator&& accumulator)
+    {
+        return Observable<T>::create(std::shared_ptr<OnSubscribeBase<T>>(
+                   std::make_shared<OnSubscribeParallelReduce<T, Accumulator>>(
+                       onSubscribe, std::forward<Accumulator>(accumulator))));
+    }
+
+    //Collects each rail in parallel into a container from supplier() with
+    //collector(container, value), then folds the rails' containers with
+    //combiner(into, from). Order of the values within a container is not kept.
+    template<typename Supplier, typename Collector, typename Combiner>
+    Observable<typename std::decay<typename std::result_of<Supplier()>::type>::type>
+    collect(Supplier&& supplier, Collector&& collector, Combiner&& combiner)
+    {
+        typedef typename std::decay<typename std::result_of<Supplier()>::type>::type C;
+        return Observable<C>::create(std::shared_ptr<OnSubscribeBase<C>>(
+                   std::make_shared<OnSubscribeParallelCollect<T, C, Supplier, Collector, Combiner>>(
+                       onSubscribe, std::forward<Supplier>(supplier), std::forward<Collector>(collector),
+                       std::forward<Combiner>(combiner))));
+    }
+
+    //Merges the rails as their values arrive, or in source order when ordered
+    //is set (values finished early wait for their predecessors).
+    Observable<T> sequential(bool ordered = false)
+    {
+        return Observable<T>::create(std::shared_ptr<OnSubscribeBase<T>>(
+                   std::make_shared<OnSubscribeSequential<T>>(onSubscribe, ordered)));
+    }
+
+private:
+    template<typename R, typename F>
+    ParallelObservable<R> lift(F&& f)
+    {
+        std::unique_ptr<Operator<Sequenced<T>, Sequenced<R>>> op(
+                    make_unique<OperatorMap<Sequenced<T>, F>>(std::forward<F>(f)));
+        return ParallelObservable<R>(std::make_shared<ParallelLiftOnSubscribe<R, T>>(onSubscribe, std::move(op)));
+    }
+
+    ParallelOnSubscribePtrType onSubscribe;
+};
+
+template<typename T>
+ParallelObservable<T> Observable<T>::parallel(size_t rails, const Scheduler::SchedulerRefType& scheduler)
+{
+    return ParallelObservable<T>(std::make_shared<ParallelSourceOnSubscribe<T>>(
+                                     onSubscribe, rails, scheduler, nullptr));
+}
+
+template<typename T>
+template<typename KeySelector>
+ParallelObservable<T> Observable<T>::parallel(size_t rails, const Scheduler::SchedulerRefType& scheduler,
+                                              KeySelector&& keySelector)
+{
+    typedef typename std::decay<KeySelector>::type KeySelectorType;
+    typedef typename std::decay<typename std::result_of<KeySelectorType(const T&)>::type>::type KeyType;
+    KeySelectorType selector(std::forward<KeySelector>(keySelector));
+    return ParallelObservable<T>(std::make_shared<ParallelSourceOnSubscribe<T>>(
+                                     onSubscribe, rails, scheduler, [selector](const T& t){
+                                         return std::hash<KeyType>()(selector(t));
+                                     }));
+}
+
+#endif // PARALLELOBSERVABLE_HPP
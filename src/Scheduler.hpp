@@ -2,10 +2,15 @@
 #define SCHEDULER
 #include "Subscription.hpp"
 #include "Functions.hpp"
+#include "utils/PriorityMTQueue.hpp"
+#include "utils/TimerQueue.hpp"
 #include <chrono>
+#include <exception>
 #include <thread>
 #include <atomic>
 #include <limits>
+#include <mutex>
+#include <queue>
 
 class ScheduledAction : public Action0, public SubscriptionBase
 {
@@ -38,36 +43,92 @@ protected:
     std::atomic<bool> unsubscr;
 };
 
-template<typename Rep, typename Period>
-class PeriodicScheduledAction : public ScheduledAction
+using ScheduledActionPrtType = std::shared_ptr<ScheduledAction>;
+
+//Runs actions inline on the calling thread. Actions submitted while another
+//one is running on the same thread are queued and drained by the outermost call,
+//so nested inline scheduling never grows the stack.
+class Trampoline
 {
 public:
-    PeriodicScheduledAction(ActionRefType act, const std::chrono::duration<Rep, Period>&  delay,
-                                               const std::chrono::duration<Rep, Period>&  period , size_t count) :
-        ScheduledAction(std::move(act)), delay(delay), period(period), count(count)
-    {}
-
-    virtual void operator()()
+    template<typename F>
+    static void run(F&& f)
     {
-        std::this_thread::sleep_for(delay);
-        while(!this->unsubscr.load() && count)
+        State& state = current();
+        if(state.active)
+        {
+            state.queue.push(std::make_shared<Action0>(Action0_t(std::forward<F>(f))));
+            return;
+        }
+
+        //Queued actions belong to other chains: a throwing action must not
+        //discard them, so the queue is drained first and the first error rethrown.
+        ActiveGuard guard(state);
+        std::exception_ptr error;
+        try
+        {
+            f();
+        }
+        catch(...)
         {
-            (*this->action)();
-            std::this_thread::sleep_for(period);
-            if(count != std::numeric_limits<int>::max())
+            error = std::current_exception();
+        }
+        while(!state.queue.empty())
+        {
+            ActionRefType next = std::move(state.queue.front());
+            state.queue.pop();
+            try
+            {
+                (*next)();
+            }
+            catch(...)
             {
-                --count;
+                if(!error)
+                {
+                    error = std::current_exception();
+                }
             }
         }
+        if(error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    //An action is running through run() on the calling thread.
+    static bool isActive()
+    {
+        return current().active;
     }
+
 private:
-    const std::chrono::duration<Rep, Period>&  delay;
-    const std::chrono::duration<Rep, Period>&  period;
-    size_t count;
-};
+    struct State
+    {
+        bool active = false;
+        std::queue<ActionRefType> queue;
+    };
+
+    struct ActiveGuard
+    {
+        ActiveGuard(State& s) : state(s)
+        {
+            state.active = true;
+        }
 
+        ~ActiveGuard()
+        {
+            state.active = false;
+        }
 
-using ScheduledActionPrtType = std::shared_ptr<ScheduledAction>;
+        State& state;
+    };
+
+    static State& current()
+    {
+        static thread_local State state;
+        return state;
+    }
+};
 
 class Scheduler
 {
@@ -75,35 +136,200 @@ public:
     virtual ~Scheduler() = default;
     using SchedulerRefType = std::shared_ptr<Scheduler>;
 
-    class Worker
+    class Worker : public std::enable_shared_from_this<Worker>
     {
     public:
         virtual ~Worker() = default;
 
         SubscriptionPtrType schedule(ActionRefType action)
+        {
+            return schedule(std::move(action), Priority::Normal);
+        }
+
+        SubscriptionPtrType schedule(ActionRefType action, Priority priority)
         {
             auto scAction = std::make_shared<ScheduledAction>(action);
-            auto internalSubscription = scheduleInteranal(scAction);
+            return combine(scAction, schedulePrioritized(scAction, priority));
+        }
 
-            if(internalSubscription == nullptr)
+        //The action should start before the deadline. Deadline-aware workers order
+        //their queue by it; the others schedule the action as usual.
+        SubscriptionPtrType schedule(ActionRefType action, std::chrono::steady_clock::time_point deadline)
+        {
+            auto scAction = std::make_shared<ScheduledAction>(action);
+            return combine(scAction, scheduleWithDeadline(scAction, deadline));
+        }
+
+        //Runs the action inline (through the trampoline) when the calling thread
+        //already belongs to this worker, otherwise schedules it as usual.
+        SubscriptionPtrType scheduleOrRun(ActionRefType action, Priority priority = Priority::Normal)
+        {
+            if(!isCurrentThread())
             {
-                return scAction;
+                return schedule(std::move(action), priority);
             }
 
-            auto subscriptions = std::make_shared<SubscriptionsList>();
-            subscriptions->add(scAction);
-            subscriptions->add(internalSubscription);
+            auto scAction = std::make_shared<ScheduledAction>(std::move(action));
+            Trampoline::run([scAction](){
+                (*scAction)();
+            });
+            return scAction;
+        }
 
-            return subscriptions;
+        virtual bool isCurrentThread()
+        {
+            return false;
+        }
+
+        //Runs the action on this worker once the delay has passed. The wait happens
+        //on the shared timer, no thread sleeps for it.
+        template<typename Rep, typename Period>
+        SubscriptionPtrType scheduleDelayed(ActionRefType action, const std::chrono::duration<Rep, Period>& delay)
+        {
+            auto scAction = std::make_shared<ScheduledAction>(std::move(action));
+            auto due = now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay);
+            return combine(scAction, scheduleAt(scAction, due));
+        }
+
+        //Time of the worker's clock; virtual for schedulers with a clock of their own.
+        virtual std::chrono::steady_clock::time_point now()
+        {
+            return std::chrono::steady_clock::now();
         }
 
+        //Runs the action count times on this worker, the first time after delay and
+        //then at a fixed rate. Waiting between runs is left to the shared timer.
         template<typename Rep, typename Period>
         SubscriptionPtrType schedulePeriodically(ActionRefType action, const std::chrono::duration<Rep, Period>&  delay,
                                           const std::chrono::duration<Rep, Period>&  period, size_t count = std::numeric_limits<size_t>::max())
         {
-            auto scAction = std::make_shared<PeriodicScheduledAction<Rep, Period>>(action, delay, period, count);
-            auto internalSubscription = scheduleInteranal(scAction);
+            auto scAction = std::make_shared<ScheduledAction>(std::move(action));
+            if(count == 0)
+            {
+                return scAction;
+            }
+            auto task = std::make_shared<PeriodicTask>(shared_from_this(), scAction,
+                                                       std::chrono::duration_cast<std::chrono::steady_clock::duration>(period),
+                                                       count);
+            task->arm(now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay));
+            return combine(scAction, std::make_shared<PeriodicTask::Cancel>(task));
+        }
+    protected:
+        virtual SubscriptionPtrType scheduleInteranal(ActionRefType action) = 0;
+
+        //Workers without priority lanes ignore the priority.
+        virtual SubscriptionPtrType schedulePrioritized(ActionRefType action, Priority priority)
+        {
+            (void)priority;
+            return scheduleInteranal(std::move(action));
+        }
+
+        virtual SubscriptionPtrType scheduleWithDeadline(ActionRefType action,
+                                                         std::chrono::steady_clock::time_point deadline)
+        {
+            (void)deadline;
+            return scheduleInteranal(std::move(action));
+        }
+
+        virtual SubscriptionPtrType scheduleAt(ActionRefType action, std::chrono::steady_clock::time_point due)
+        {
+            auto self = shared_from_this();
+            return TimerQueue::instance().schedule(std::make_shared<Action0>([self, action](){
+                self->scheduleInteranal(action);
+            }), due);
+        }
+
+    private:
+        //Re-arms itself after every run, due times advance by exactly one period.
+        struct PeriodicTask : public std::enable_shared_from_this<PeriodicTask>
+        {
+            //Takes the pending timer off the shared timer once the action is unsubscribed.
+            struct Cancel : public SubscriptionBase
+            {
+                Cancel(const std::shared_ptr<PeriodicTask>& task) : task(task), cancelled(false)
+                {}
+
+                bool isUnsubscribe() override
+                {
+                    return cancelled.load();
+                }
+
+                void unsubscribe() override
+                {
+                    cancelled.store(true);
+                    if(auto t = task.lock())
+                    {
+                        t->cancel();
+                    }
+                }
+
+                std::weak_ptr<PeriodicTask> task;
+                std::atomic<bool> cancelled;
+            };
+
+            PeriodicTask(std::shared_ptr<Worker> worker, ScheduledActionPrtType action,
+                         std::chrono::steady_clock::duration period, size_t count) :
+                worker(std::move(worker)), action(std::move(action)), period(period), count(count)
+            {}
+
+            void arm(std::chrono::steady_clock::time_point at)
+            {
+                due = at;
+                auto self = this->shared_from_this();
+                auto handle = worker->scheduleAt(std::make_shared<Action0>([self](){
+                    self->run();
+                }), due);
+                std::lock_guard<std::mutex> l(lock);
+                timer = handle;
+                //Unsubscribed while arming: cancel() may have missed the new timer.
+                if(timer != nullptr && action->isUnsubscribe())
+                {
+                    timer->unsubscribe();
+                }
+            }
+
+            void cancel()
+            {
+                SubscriptionPtrType pending;
+                {
+                    std::lock_guard<std::mutex> l(lock);
+                    pending = std::move(timer);
+                }
+                if(pending != nullptr)
+                {
+                    pending->unsubscribe();
+                }
+            }
+
+            void run()
+            {
+                if(action->isUnsubscribe())
+                {
+                    return;
+                }
+                (*action)();
+                if(count != std::numeric_limits<size_t>::max())
+                {
+                    --count;
+                }
+                if(count > 0 && !action->isUnsubscribe())
+                {
+                    arm(due + period);
+                }
+            }
+
+            std::shared_ptr<Worker> worker;
+            ScheduledActionPrtType action;
+            const std::chrono::steady_clock::duration period;
+            size_t count;
+            std::chrono::steady_clock::time_point due;
+            std::mutex lock;
+            SubscriptionPtrType timer;
+        };
 
+        static SubscriptionPtrType combine(const ScheduledActionPrtType& scAction,
+                                           const SubscriptionPtrType& internalSubscription)
+        {
             if(internalSubscription == nullptr)
             {
                 return scAction;
@@ -115,12 +341,17 @@ public:
 
             return subscriptions;
         }
-    protected:
-        virtual SubscriptionPtrType scheduleInteranal(ActionRefType action) = 0;
     };
 
     using WorkerRefType = std::shared_ptr<Worker>;
     virtual WorkerRefType createWorker() = 0;
+
+    //Schedulers with thread affinity return the same worker for the same key hash.
+    virtual WorkerRefType createWorkerForKey(size_t keyHash)
+    {
+        (void)keyHash;
+        return createWorker();
+    }
 };
 
 #endif // SCHEDULER
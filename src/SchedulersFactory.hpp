@@ -3,9 +3,14 @@
 
 #include "schedulers/NewThreadScheduler.hpp"
 #include "schedulers/ThreadPoolScheduler.hpp"
+#include "schedulers/PartitionedScheduler.hpp"
+#include "schedulers/DeadlineScheduler.hpp"
+#include <algorithm>
 #include <mutex>
 
 #define DEFAULT_THREAD_POOL_SIZE std::thread::hardware_concurrency() * 2
+#define DEFAULT_GROW_THRESHOLD std::chrono::milliseconds(1)
+#define DEFAULT_KEEP_ALIVE std::chrono::seconds(60)
 
 class SchedulersFactory
 {
@@ -29,18 +34,38 @@ public:
         return newThreadInstance;
     }
 
-    Scheduler::SchedulerRefType threadPoolScheduler(size_t poolSize = DEFAULT_THREAD_POOL_SIZE)
+    //poolSize of 0 means DEFAULT_THREAD_POOL_SIZE. Asking an existing pool for a
+    //larger size than its configured minimum raises the minimum (and the maximum
+    //when below it); it is never shrunk.
+    Scheduler::SchedulerRefType threadPoolScheduler(size_t poolSize = 0)
     {
+        std::lock_guard<std::mutex> l(lockMutex);
         if(!threadPoolInstance)
         {
-            std::lock_guard<std::mutex> l(lockMutex);
-            if(!threadPoolInstance)
-            {
-                threadPoolInstance = std::make_shared<ThreadPoolScheduler>(poolSize);
-            }
+            threadPoolInstance = std::make_shared<ThreadPoolScheduler>(poolSize ? poolSize : DEFAULT_THREAD_POOL_SIZE);
+        }
+        else if(poolSize > threadPoolInstance->minPoolSize())
+        {
+            threadPoolInstance->resize(poolSize, std::max(poolSize, threadPoolInstance->maxPoolSize()));
         }
         return threadPoolInstance;
     }
+
+    //Pool growing from hardware_concurrency() up to DEFAULT_THREAD_POOL_SIZE threads
+    //when tasks wait longer than DEFAULT_GROW_THRESHOLD and shrinking back after
+    //DEFAULT_KEEP_ALIVE of idleness. Construct a ThreadPoolScheduler directly for other bounds.
+    Scheduler::SchedulerRefType elasticThreadPoolScheduler()
+    {
+        std::lock_guard<std::mutex> l(lockMutex);
+        if(!elasticThreadPoolInstance)
+        {
+            elasticThreadPoolInstance = std::make_shared<ThreadPoolScheduler>(std::thread::hardware_concurrency(),
+                                                                               DEFAULT_THREAD_POOL_SIZE,
+                                                                               DEFAULT_GROW_THRESHOLD,
+                                                                               DEFAULT_KEEP_ALIVE);
+        }
+        return elasticThreadPoolInstance;
+    }
 private:
     SchedulersFactory() = default;
     ~SchedulersFactory() = default;
@@ -48,7 +73,8 @@ private:
 
     std::mutex lockMutex;
     Scheduler::SchedulerRefType newThreadInstance;
-    Scheduler::SchedulerRefType threadPoolInstance;
+    std::shared_ptr<ThreadPoolScheduler> threadPoolInstance;
+    std::shared_ptr<ThreadPoolScheduler> elasticThreadPoolInstance;
 };
 
 #endif // SCHEDULERSFACTORY
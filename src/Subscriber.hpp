@@ -29,6 +29,11 @@ public:
         subscriptions.add(subscription);
     }
 
+    void remove(const SubscriptionPtrType& subscription)
+    {
+        subscriptions.remove(subscription);
+    }
+
     virtual void onStart()
     {}
 protected:
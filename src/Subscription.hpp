@@ -2,7 +2,9 @@
 #define SUBSCRIPTION
 #include <memory>
 #include <mutex>
+#include <atomic>
 #include <vector>
+#include <algorithm>
 #include "utils/Util.hpp"
 
 struct SubscriptionBase : std::enable_shared_from_this<SubscriptionBase>
@@ -52,17 +54,38 @@ class SubscriptionsList : public SubscriptionBase
 public:
     void add(const SubscriptionPtrType& subscription)
     {
+        std::unique_lock<std::mutex> l(lockMutex);
+        if(unsubscr.load())
+        {
+            l.unlock();
+            if(subscription != nullptr)
+            {
+                subscription->unsubscribe();
+            }
+            return;
+        }
         subscriptions.push_back(subscription);
     }
 
+    void remove(const SubscriptionPtrType& subscription)
+    {
+        std::lock_guard<std::mutex> l(lockMutex);
+        auto it = std::find(subscriptions.begin(), subscriptions.end(), subscription);
+        if(it != subscriptions.end())
+        {
+            std::swap(*it, subscriptions.back());
+            subscriptions.pop_back();
+        }
+    }
+
     bool isUnsubscribe()
     {
-        return unsubscr;
+        return unsubscr.load();
     }
 
     void unsubscribe()
     {
-        if(!unsubscr)
+        if(!unsubscr.load())
         {
             std::lock_guard<std::mutex> l(lockMutex);
             for(auto s : subscriptions)
@@ -72,13 +95,65 @@ public:
                     s->unsubscribe();
                 }
             }
-            unsubscr = true;
+            unsubscr.store(true);
         }
     }
 private:
     std::vector<SubscriptionPtrType> subscriptions;
     std::mutex lockMutex;
-    volatile bool unsubscr = false;
+    std::atomic<bool> unsubscr{false};
+};
+
+//Holds one replaceable subscription, such as the pending timer of an operator
+//that re-arms it. Setting a new one unsubscribes the previous one; once this is
+//unsubscribed, whatever is set later is unsubscribed right away.
+class SerialSubscription : public SubscriptionBase
+{
+public:
+    void set(const SubscriptionPtrType& subscription)
+    {
+        SubscriptionPtrType previous;
+        {
+            std::lock_guard<std::mutex> l(lockMutex);
+            if(!unsubscr)
+            {
+                previous = std::move(current);
+                current = subscription;
+            }
+            else
+            {
+                previous = subscription;
+            }
+        }
+        if(previous != nullptr)
+        {
+            previous->unsubscribe();
+        }
+    }
+
+    bool isUnsubscribe() override
+    {
+        std::lock_guard<std::mutex> l(lockMutex);
+        return unsubscr;
+    }
+
+    void unsubscribe() override
+    {
+        SubscriptionPtrType previous;
+        {
+            std::lock_guard<std::mutex> l(lockMutex);
+            unsubscr = true;
+            previous = std::move(current);
+        }
+        if(previous != nullptr)
+        {
+            previous->unsubscribe();
+        }
+    }
+private:
+    SubscriptionPtrType current;
+    std::mutex lockMutex;
+    bool unsubscr = false;
 };
 
 #endif // SUBSCRIPTION
@@ -41,4 +41,20 @@ struct NullPointerException : public TRException
         return "Object is null.";
     }
 };
+
+struct IllegalStateException : public TRException
+{
+    virtual const char* what() const noexcept
+    {
+        return "Observable can be subscribed only once.";
+    }
+};
+
+struct TimeoutException : public TRException
+{
+    virtual const char* what() const noexcept
+    {
+        return "No value arrived in time.";
+    }
+};
 #endif // TREXCEPTIONS_H
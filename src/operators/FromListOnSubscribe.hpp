@@ -0,0 +1,39 @@
+#ifndef FROMLISTONSUBSCRIBE_HPP
+#define FROMLISTONSUBSCRIBE_HPP
+#include "OnSubscribeBase.hpp"
+#include <iterator>
+#include <vector>
+
+template<typename T>
+class FromListOnSubscribe : public OnSubscribeBase<T>
+{
+public:
+    template<typename L>
+    FromListOnSubscribe(const L& list) : list(std::begin(list), std::end(list))
+    {}
+
+    void operator()(const SubscriberPtrType<T>& t) override
+    {
+        for(auto value = list.begin(); value != list.end(); ++value)
+        {
+            t->onNext(*value);
+        }
+        t->onComplete();
+    }
+
+    bool isSynchronous() const override
+    {
+        return true;
+    }
+
+    void drainSync(const SyncConsumer<T>& consumer) override
+    {
+        for(auto value = list.begin(); value != list.end() && consumer(*value); ++value)
+        {}
+    }
+
+private:
+    std::vector<T> list;
+};
+
+#endif // FROMLISTONSUBSCRIBE_HPP
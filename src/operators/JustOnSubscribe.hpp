@@ -0,0 +1,35 @@
+#ifndef JUSTONSUBSCRIBE_HPP
+#define JUSTONSUBSCRIBE_HPP
+#include "OnSubscribeBase.hpp"
+
+template<typename T>
+class JustOnSubscribe : public OnSubscribeBase<T>
+{
+public:
+    JustOnSubscribe(const T& value) : value(value)
+    {}
+
+    JustOnSubscribe(T&& value) : value(std::move(value))
+    {}
+
+    void operator()(const SubscriberPtrType<T>& t) override
+    {
+        t->onNext(value);
+        t->onComplete();
+    }
+
+    bool isSynchronous() const override
+    {
+        return true;
+    }
+
+    void drainSync(const SyncConsumer<T>& consumer) override
+    {
+        consumer(value);
+    }
+
+private:
+    T value;
+};
+
+#endif // JUSTONSUBSCRIBE_HPP
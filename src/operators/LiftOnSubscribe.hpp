@@ -1,13 +1,15 @@
 #ifndef LIFTONSUBSCRIBE_HPP
 #define LIFTONSUBSCRIBE_HPP
 #include "OnSubscribeBase.hpp"
+#include "Operator.hpp"
 
 template<typename A, typename B>
 class LiftOnSubscribe : public OnSubscribeBase<A>
 {
 public:
     LiftOnSubscribe(std::shared_ptr<OnSubscribeBase<B>> parent, std::unique_ptr<Operator<B, A>> o) :
-                    OnSubscribeBase<A>(), parentOnSubscribe(parent), op(std::move(o))
+                    OnSubscribeBase<A>(), parentOnSubscribe(parent), op(std::move(o)),
+                    fusable(dynamic_cast<FusableOperator<B, A>*>(op.get()))
     {
     }
 
@@ -17,9 +19,23 @@ public:
         (*parentOnSubscribe)(std::move(st));
     }
 
+    bool isSynchronous() const override
+    {
+        return fusable != nullptr && parentOnSubscribe->isSynchronous();
+    }
+
+    void drainSync(const SyncConsumer<A>& consumer) override
+    {
+        FusableOperator<B, A>* f = fusable;
+        parentOnSubscribe->drainSync([f, &consumer](const B& b){
+            return f->applySync(b, consumer);
+        });
+    }
+
 protected:
     std::shared_ptr<OnSubscribeBase<B>> parentOnSubscribe;
     std::unique_ptr<Operator<B, A>> op;
+    FusableOperator<B, A>* fusable;
 };
 
 #endif // LIFTONSUBSCRIBE_HPP
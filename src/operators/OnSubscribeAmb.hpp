@@ -0,0 +1,157 @@
+#ifndef ONSUBSCRIBEAMB_HPP
+#define ONSUBSCRIBEAMB_HPP
+#include "OnSubscribeBase.hpp"
+#include "../Scheduler.hpp"
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+//Mirrors the first source to signal anything and unsubscribes the others as
+//soon as it wins. With a stagger, source k is only subscribed k * stagger
+//after the first one, and not at all when a winner is known by then; the
+//delays wait on the shared timer.
+template<typename T>
+class OnSubscribeAmb : public OnSubscribeBase<T>
+{
+public:
+    using OnSubscribePtrType  = std::shared_ptr<OnSubscribeBase<T>>;
+    using ChildSubscriberType = typename CompositeSubscriber<T,T>::ChildSubscriberType;
+
+    struct AmbSubscriber;
+    using AmbSubscriberPtrType = std::shared_ptr<AmbSubscriber>;
+
+    struct AmbState
+    {
+        AmbState(size_t count) : winner(-1)
+        {
+            candidates.reserve(count);
+        }
+
+        //True when the candidate may deliver, deciding the race if still open.
+        bool claim(int index)
+        {
+            int current = winner.load(std::memory_order_acquire);
+            if(current == index)
+            {
+                return true;
+            }
+            if(current != -1 || !winner.compare_exchange_strong(current, index))
+            {
+                return current == index;
+            }
+            for(size_t i = 0; i < candidates.size(); ++i)
+            {
+                auto loser = candidates[i].lock();
+                if(static_cast<int>(i) != index && loser != nullptr)
+                {
+                    loser->unsubscribe();
+                }
+            }
+            return true;
+        }
+
+        std::atomic<int> winner;
+        //Filled before any source is subscribed.
+        std::vector<std::weak_ptr<SubscriptionBase>> candidates;
+        //Keeps the sources alive, see OperatorSubscribeOn.
+        std::vector<OnSubscribePtrType> sources;
+    };
+
+    struct AmbSubscriber : public CompositeSubscriber<T,T>
+    {
+        AmbSubscriber(ChildSubscriberType child, std::shared_ptr<AmbState> state, int index) :
+            CompositeSubscriber<T,T>(child), state(state), index(index)
+        {}
+
+        void onNext(const T& t) override
+        {
+            if(state->claim(index))
+            {
+                this->child->onNext(t);
+            }
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            if(state->claim(index))
+            {
+                this->child->onError(ex);
+            }
+        }
+
+        void onComplete() override
+        {
+            if(state->claim(index))
+            {
+                this->child->onComplete();
+            }
+        }
+
+        std::shared_ptr<AmbState> state;
+        const int index;
+    };
+
+    OnSubscribeAmb(std::vector<OnSubscribePtrType> sources) : sources(std::move(sources))
+    {}
+
+    template<typename Rep, typename Period>
+    OnSubscribeAmb(std::vector<OnSubscribePtrType> sources, const std::chrono::duration<Rep, Period>& stagger,
+                   const Scheduler::SchedulerRefType& scheduler) :
+        sources(std::move(sources)), stagger(std::chrono::duration_cast<std::chrono::steady_clock::duration>(stagger)),
+        scheduler(scheduler)
+    {}
+
+    void operator()(const SubscriberPtrType<T>& subscriber) override
+    {
+        if(subscriber == nullptr || sources.empty())
+        {
+            return;
+        }
+
+        auto state = std::make_shared<AmbState>(sources.size());
+        state->sources = sources;
+        std::vector<AmbSubscriberPtrType> candidates;
+        for(size_t i = 0; i < sources.size(); ++i)
+        {
+            auto candidate = std::make_shared<AmbSubscriber>(subscriber, state, static_cast<int>(i));
+            state->candidates.push_back(candidate);
+            candidates.push_back(candidate);
+            subscriber->add(candidate);
+        }
+
+        Scheduler::WorkerRefType worker;
+        for(size_t i = 0; i < sources.size(); ++i)
+        {
+            AmbSubscriberPtrType candidate = candidates[i];
+            if(i == 0 || scheduler == nullptr)
+            {
+                subscribeCandidate(sources[i], candidate);
+                continue;
+            }
+
+            if(worker == nullptr)
+            {
+                worker = scheduler->createWorker();
+            }
+            OnSubscribePtrType source = sources[i];
+            subscriber->add(worker->scheduleDelayed(std::make_shared<Action0>([source, candidate](){
+                subscribeCandidate(source, candidate);
+            }), stagger * static_cast<int>(i)));
+        }
+    }
+
+private:
+    static void subscribeCandidate(const OnSubscribePtrType& source, const AmbSubscriberPtrType& candidate)
+    {
+        if(!candidate->isUnsubscribe() && candidate->state->winner.load() == -1)
+        {
+            (*source)(candidate);
+        }
+    }
+
+    std::vector<OnSubscribePtrType> sources;
+    std::chrono::steady_clock::duration stagger;
+    Scheduler::SchedulerRefType scheduler;
+};
+
+#endif // ONSUBSCRIBEAMB_HPP
@@ -6,6 +6,10 @@
 template<typename T>
 using SubscriberPtrType = std::shared_ptr<Subscriber<T>>;
 
+//Receives the values of a synchronous drain, returns false to stop it.
+template<typename T>
+using SyncConsumer = std::function<bool(const T&)>;
+
 template<typename R>
 class OnSubscribeBase : public Action1<SubscriberPtrType<R>>
 {
@@ -14,6 +18,20 @@ public:
 
     OnSubscribeBase(typename Action1<SubscriberPtrType<R>>::ActionFp fp) :
         Action1<SubscriberPtrType<R>>(fp){}
+
+    //True for sources that emit all their values on the calling thread and then
+    //complete. Flattening operators pull such sources through drainSync instead
+    //of subscribing an inner subscriber.
+    virtual bool isSynchronous() const
+    {
+        return false;
+    }
+
+    //Passes every value to the consumer, completion is implied by the return.
+    virtual void drainSync(const SyncConsumer<R>& consumer)
+    {
+        (void)consumer;
+    }
 };
 
 #endif // ONSUBSCRIBEBASE_HPP
@@ -0,0 +1,133 @@
+#ifndef ONSUBSCRIBECOMBINELATEST_HPP
+#define ONSUBSCRIBECOMBINELATEST_HPP
+#include "OnSubscribeZip.hpp"
+
+//Combines the latest values of all sources every time one of them emits, once
+//each has emitted at least once. Completes when all sources have completed, or
+//as soon as one completes without ever emitting. Values are combined in the
+//order they arrived across sources, which an extra queue of source indexes
+//records.
+template<typename R, typename Combiner, typename ...T>
+class OnSubscribeCombineLatest : public OnSubscribeBase<R>
+{
+public:
+    using CombinerType = typename std::decay<Combiner>::type;
+    using SourcesType  = std::tuple<std::shared_ptr<OnSubscribeBase<T>>...>;
+
+    class CombineLatestState : public MultiSourceState<CombineLatestState, R, T...>
+    {
+        using Base = MultiSourceState<CombineLatestState, R, T...>;
+        friend Base;
+    public:
+        CombineLatestState(typename Base::ChildSubscriberType child, const CombinerType& combiner,
+                           size_t bufferSize) :
+            Base(std::move(child), bufferSize), combiner(combiner), missing(sizeof...(T))
+        {
+            has.fill(false);
+        }
+
+    private:
+        using StepType = void (CombineLatestState::*)();
+
+        //Called after the value is queued, so an index never runs ahead of its value.
+        void pushed(size_t index)
+        {
+            order.push(index);
+        }
+
+        void drainValues()
+        {
+            static const std::array<StepType, sizeof...(T)> steps = makeSteps(typename Base::Indexes());
+            size_t index;
+            while(!this->finished && order.tryPop(index))
+            {
+                (this->*steps[index])();
+            }
+            if(this->finished)
+            {
+                return;
+            }
+            if(allExhausted(typename Base::Indexes()) || anyEmptyExhausted(typename Base::Indexes()))
+            {
+                this->emitComplete();
+            }
+        }
+
+        template<size_t... I>
+        static std::array<StepType, sizeof...(T)> makeSteps(IndexSequence<I...>)
+        {
+            return {{&CombineLatestState::template step<I>...}};
+        }
+
+        template<size_t I>
+        void step()
+        {
+            if(!this->template tryPop<I>(std::get<I>(latest)))
+            {
+                return;
+            }
+            if(!has[I])
+            {
+                has[I] = true;
+                --missing;
+            }
+            if(missing == 0)
+            {
+                try
+                {
+                    emit(typename Base::Indexes());
+                }
+                catch(...)
+                {
+                    this->emitError(std::current_exception());
+                }
+            }
+        }
+
+        template<size_t... I>
+        void emit(IndexSequence<I...>)
+        {
+            this->child->onNext(combiner(std::get<I>(latest)...));
+        }
+
+        template<size_t... I>
+        bool allExhausted(IndexSequence<I...>)
+        {
+            bool exhausted[] = {this->template exhausted<I>()...};
+            return std::all_of(std::begin(exhausted), std::end(exhausted), [](bool b){ return b; });
+        }
+
+        template<size_t... I>
+        bool anyEmptyExhausted(IndexSequence<I...>)
+        {
+            bool exhausted[] = {(!has[I] && this->template exhausted<I>())...};
+            return std::any_of(std::begin(exhausted), std::end(exhausted), [](bool b){ return b; });
+        }
+
+        CombinerType combiner;
+        MPSCQueue<size_t> order;
+        typename Base::ValuesType latest;
+        std::array<bool, sizeof...(T)> has;
+        size_t missing;
+    };
+
+    OnSubscribeCombineLatest(const CombinerType& combiner, const SourcesType& sources, size_t bufferSize) :
+        combiner(combiner), sources(sources), bufferSize(bufferSize)
+    {}
+
+    void operator()(const SubscriberPtrType<R>& subscriber) override
+    {
+        if(subscriber == nullptr)
+        {
+            return;
+        }
+        std::make_shared<CombineLatestState>(subscriber, combiner, bufferSize)->subscribe(sources);
+    }
+
+private:
+    CombinerType combiner;
+    SourcesType sources;
+    size_t bufferSize;
+};
+
+#endif // ONSUBSCRIBECOMBINELATEST_HPP
@@ -89,7 +89,19 @@ public:
                     }
                     auto o = extQueue.front();
                     extQueue.pop();
-                    auto obs = std::make_shared<MapObservableType>(std::move(mapper(o)));
+                    MapObservableType mapped = mapper(o);
+                    //Synchronous inners are pulled inline, no inner subscriber needed.
+                    if(mapped.isSynchronous())
+                    {
+                        active = true;
+                        mapped.drainSync([this](const R& r){
+                            onNextInner(r);
+                            return !this->isUnsubscribe();
+                        });
+                        onCompleteInner();
+                        continue;
+                    }
+                    auto obs = std::make_shared<MapObservableType>(std::move(mapped));
                     std::shared_ptr<Subscriber<R>> innerSubscriber = std::make_shared<InnerConcatMapSubscriber>
                             (std::dynamic_pointer_cast<ConcatMapSubscriber>(this->shared_from_this()));
                     active = true;
@@ -0,0 +1,319 @@
+#ifndef ONSUBSCRIBECONCATMAPEAGER_HPP
+#define ONSUBSCRIBECONCATMAPEAGER_HPP
+#include "OnSubscribeBase.hpp"
+#include "../utils/MPSCQueue.hpp"
+#include "../exceptions/TRExceptions.hpp"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//concatMap that subscribes up to maxConcurrency inner observables at once. Each
+//inner buffers its values (at most prefetch of them, SlowSubscriberException
+//otherwise) and the buffers are drained in source order, so the output matches
+//concatMap while the inners run in parallel.
+template<typename T, typename R, typename Mapper>
+class OnSubscribeConcatMapEager : public OnSubscribeBase<R>
+{
+public:
+    using OnSubscribePtrType      = std::shared_ptr<OnSubscribeBase<T>>;
+    using MapperType              = typename std::decay<Mapper>::type;
+    using ThisChildSubscriberType = typename CompositeSubscriber<T,R>::ChildSubscriberType;
+    using MapObservableType       = typename std::result_of<MapperType(const T&)>::type;
+
+    struct InnerConcatMapEagerSubscriber;
+    using InnerPtrType = std::shared_ptr<InnerConcatMapEagerSubscriber>;
+
+    struct ConcatMapEagerSubscriber : public CompositeSubscriber<T,R>
+    {
+        ConcatMapEagerSubscriber(ThisChildSubscriberType child, const MapperType& mapper,
+                                 size_t maxConcurrency, size_t prefetch) :
+            CompositeSubscriber<T,R>(child), mapper(mapper), maxConcurrency(maxConcurrency),
+            prefetch(prefetch), wip(0), drainingThread(std::thread::id()), head(nullptr),
+            parentComplete(false), errorClaimed(false), errorReady(false)
+        {}
+
+        void onNext(const T& t) override
+        {
+            if(this->isUnsubscribe())
+            {
+                return;
+            }
+            sources.push(t);
+            signal();
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            if(!errorClaimed.exchange(true))
+            {
+                error = ex;
+                errorReady.store(true);
+            }
+            signal();
+        }
+
+        void onComplete() override
+        {
+            parentComplete.store(true);
+            signal();
+        }
+
+        void onNextInner(InnerConcatMapEagerSubscriber* inner, const R& r)
+        {
+            //The head inner with nothing buffered may emit straight to the child.
+            if(head.load() == inner && inner->queued.load() == 0)
+            {
+                if(drainingThread.load() == std::this_thread::get_id())
+                {
+                    if(!done)
+                    {
+                        this->child->onNext(r);
+                    }
+                    return;
+                }
+
+                int expected = 0;
+                if(wip.compare_exchange_strong(expected, 1))
+                {
+                    enter();
+                    if(!done && head.load() == inner)
+                    {
+                        this->child->onNext(r);
+                    }
+                    else
+                    {
+                        inner->queue.push(r);
+                        ++inner->queued;
+                    }
+                    leave(1);
+                    return;
+                }
+            }
+
+            if(inner->queued.load() >= prefetch)
+            {
+                onError(std::make_exception_ptr(SlowSubscriberException()));
+                return;
+            }
+            inner->queue.push(r);
+            ++inner->queued;
+            signal();
+        }
+
+        void onCompleteInner()
+        {
+            signal();
+        }
+
+        void signal()
+        {
+            if(wip.fetch_add(1) == 0)
+            {
+                enter();
+                drainOnce();
+                leave(1);
+            }
+        }
+
+        void enter()
+        {
+            drainingThread.store(std::this_thread::get_id());
+        }
+
+        //Gives up wip, draining again for every signal that came in meanwhile.
+        void leave(int missed)
+        {
+            while(true)
+            {
+                drainingThread.store(std::thread::id());
+                missed = wip.fetch_sub(missed) - missed;
+                if(missed == 0)
+                {
+                    return;
+                }
+                enter();
+                drainOnce();
+            }
+        }
+
+        //Runs on the thread owning wip only.
+        void drainOnce()
+        {
+            while(!done)
+            {
+                if(this->isUnsubscribe())
+                {
+                    done = true;
+                    clear();
+                    return;
+                }
+
+                if(errorReady.load())
+                {
+                    done = true;
+                    this->child->onError(error);
+                    this->unsubscribe();
+                    clear();
+                    return;
+                }
+
+                T t;
+                while(active.size() < maxConcurrency && sources.tryPop(t))
+                {
+                    subscribeInner(t);
+                }
+
+                if(active.empty())
+                {
+                    if(parentComplete.load() && sources.empty())
+                    {
+                        done = true;
+                        this->child->onComplete();
+                    }
+                    return;
+                }
+
+                InnerPtrType inner = active.front();
+                bool innerDone = inner->done.load();
+                R r;
+                while(!done && inner->queue.tryPop(r))
+                {
+                    --inner->queued;
+                    this->child->onNext(r);
+                }
+
+                if(!innerDone || inner->queued.load() != 0)
+                {
+                    return;
+                }
+
+                active.pop_front();
+                this->remove(inner);
+                head.store(active.empty() ? nullptr : active.front().get());
+            }
+        }
+
+        void subscribeInner(const T& t)
+        {
+            MapObservableType mapped = mapper(t);
+            //A synchronous inner with nothing ahead of it is pulled inline.
+            if(active.empty() && mapped.isSynchronous())
+            {
+                mapped.drainSync([this](const R& r){
+                    this->child->onNext(r);
+                    return !this->isUnsubscribe();
+                });
+                return;
+            }
+
+            auto obs = std::make_shared<MapObservableType>(std::move(mapped));
+            InnerPtrType innerSubscriber = std::make_shared<InnerConcatMapEagerSubscriber>
+                    (std::static_pointer_cast<ConcatMapEagerSubscriber>(this->shared_from_this()));
+
+            active.push_back(innerSubscriber);
+            if(active.size() == 1)
+            {
+                head.store(innerSubscriber.get());
+            }
+            this->add(innerSubscriber);
+            addObservableReference(obs);
+            obs->subscribe(std::static_pointer_cast<Subscriber<R>>(innerSubscriber));
+        }
+
+        void clear()
+        {
+            head.store(nullptr);
+            active.clear();
+        }
+
+        void addObservableReference(const std::shared_ptr<MapObservableType>& obs)
+        {
+            pool.push_back(obs);
+        }
+
+        MapperType mapper;
+        const size_t maxConcurrency;
+        const size_t prefetch;
+        std::atomic<int> wip;
+        std::atomic<std::thread::id> drainingThread;
+        std::atomic<InnerConcatMapEagerSubscriber*> head;
+        std::atomic<bool> parentComplete;
+        std::atomic<bool> errorClaimed;
+        std::atomic<bool> errorReady;
+        std::exception_ptr error;
+        MPSCQueue<T> sources;
+        //Owned by the thread holding wip, in source order.
+        std::deque<InnerPtrType> active;
+        bool done = false;
+        //Keep observable references
+        std::vector<std::shared_ptr<MapObservableType>> pool;
+    };
+
+    struct InnerConcatMapEagerSubscriber : public Subscriber<R>
+    {
+        InnerConcatMapEagerSubscriber(std::shared_ptr<ConcatMapEagerSubscriber> child) :
+            child(child), queued(0), done(false)
+        {}
+
+        void onNext(const R& t) override
+        {
+            child->onNextInner(this, t);
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            child->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            done.store(true);
+            child->onCompleteInner();
+        }
+
+        std::shared_ptr<ConcatMapEagerSubscriber> child;
+        MPSCQueue<R> queue;
+        std::atomic<size_t> queued;
+        std::atomic<bool> done;
+    };
+
+    OnSubscribeConcatMapEager(OnSubscribePtrType source, const MapperType& mapper,
+                              size_t maxConcurrency, size_t prefetch) :
+        source(source), mapper(mapper), maxConcurrency(std::max<size_t>(maxConcurrency, 1)),
+        prefetch(std::max<size_t>(prefetch, 1))
+    {}
+
+    OnSubscribeConcatMapEager(OnSubscribePtrType source, MapperType&& mapper,
+                              size_t maxConcurrency, size_t prefetch) :
+        source(source), mapper(std::move(mapper)), maxConcurrency(std::max<size_t>(maxConcurrency, 1)),
+        prefetch(std::max<size_t>(prefetch, 1))
+    {}
+
+    void operator()(const SubscriberPtrType<R>& s) override
+    {
+        if(s == nullptr)
+        {
+            return;
+        }
+
+        auto parent = std::make_shared<ConcatMapEagerSubscriber>(s, mapper, maxConcurrency, prefetch);
+        s->add(parent);
+
+        if(!s->isUnsubscribe())
+        {
+            (*source)(parent);
+        }
+    }
+
+private:
+    OnSubscribePtrType source;
+    MapperType mapper;
+    size_t maxConcurrency;
+    size_t prefetch;
+};
+
+#endif // ONSUBSCRIBECONCATMAPEAGER_HPP
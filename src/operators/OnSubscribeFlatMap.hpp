@@ -1,10 +1,19 @@
 #ifndef ONSUBSCRIBEFLATMAP_HPP
 #define ONSUBSCRIBEFLATMAP_HPP
 #include "OnSubscribeBase.hpp"
+#include "../utils/MPSCQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
-
+//Merges the inner observables into the child. At most maxConcurrency inners are
+//subscribed at a time, further upstream values wait in a queue. Emissions are
+//serialized without locks: the thread that takes the work-in-progress counter
+//emits, the others leave their values in the inner's queue for it. Inners that
+//emit synchronously while being subscribed go straight to the child.
 template<typename T, typename R, typename Mapper>
 class OnSubscribeFlatMap : public OnSubscribeBase<R>
 {
@@ -15,79 +24,242 @@ public:
     using MapObservableType       = typename std::result_of<MapperType(const T&)>::type;
 
     struct InnerFlatMapSubscriber;
+    using InnerPtrType = std::shared_ptr<InnerFlatMapSubscriber>;
 
     struct FlatMapSubscriber : public CompositeSubscriber<T,R>
     {
-        FlatMapSubscriber(ThisChildSubscriberType child,const MapperType& mapper) :
-            CompositeSubscriber<T,R>(child), mapper(std::move(mapper)), requested(0)
+        FlatMapSubscriber(ThisChildSubscriberType child,const MapperType& mapper, size_t maxConcurrency) :
+            CompositeSubscriber<T,R>(child), mapper(mapper), maxConcurrency(maxConcurrency),
+            wip(0), drainingThread(std::thread::id()), parentComplete(false), errorClaimed(false), errorReady(false)
         {}
 
         void onNext(const T& t) override
         {
-            ++requested;
-            if(!this->isUnsubscribe())
+            if(this->isUnsubscribe())
             {
-                auto obs = std::make_shared<MapObservableType>(std::move(mapper(t)));
-                std::shared_ptr<Subscriber<R>> innerSubscriber = std::make_shared<InnerFlatMapSubscriber>
-                        (std::dynamic_pointer_cast<FlatMapSubscriber>(this->shared_from_this()));
+                return;
+            }
 
-                obs->subscribe(innerSubscriber);
-                addObservableReference(obs);
-                this->add(innerSubscriber);
+            //Fast path: nothing waiting and a free slot, subscribe right away.
+            int expected = 0;
+            if(wip.compare_exchange_strong(expected, 1))
+            {
+                enter();
+                if(!done && sources.empty() && active.size() < maxConcurrency)
+                {
+                    subscribeInner(t);
+                }
+                else
+                {
+                    sources.push(t);
+                    drainOnce();
+                }
+                leave(1);
+                return;
             }
+
+            sources.push(t);
+            signal();
         }
 
-        void onNextInner(const R& t)
+        void onError(std::exception_ptr ex) override
         {
-            this->child->onNext(t);
+            if(!errorClaimed.exchange(true))
+            {
+                error = ex;
+                errorReady.store(true);
+            }
+            signal();
+        }
+
+        void onComplete() override
+        {
+            parentComplete.store(true);
+            signal();
+        }
+
+        void onNextInner(InnerFlatMapSubscriber* inner, const R& r)
+        {
+            //An inner emitting synchronously from inside the drain loop.
+            if(inner->queued.load() == 0 && drainingThread.load() == std::this_thread::get_id())
+            {
+                if(!done)
+                {
+                    this->child->onNext(r);
+                }
+                return;
+            }
+
+            int expected = 0;
+            if(inner->queued.load() == 0 && wip.compare_exchange_strong(expected, 1))
+            {
+                enter();
+                if(!done)
+                {
+                    this->child->onNext(r);
+                }
+                leave(1);
+                return;
+            }
+
+            inner->queue.push(r);
+            ++inner->queued;
+            signal();
         }
 
         void onErrorInner(std::exception_ptr ex)
         {
-            this->child->onError(ex);
+            onError(ex);
         }
 
         void onCompleteInner()
         {
-            --requested;
-            if(parentComplete && !done && requested.load() == 0)
+            signal();
+        }
+
+        void signal()
+        {
+            if(wip.fetch_add(1) == 0)
             {
-                done = true;
-                this->child->onComplete();
+                enter();
+                drainOnce();
+                leave(1);
             }
         }
 
-        void onComplete() override
+        void enter()
         {
-            parentComplete = true;
-            if(requested.load() == 0 && !done)
+            drainingThread.store(std::this_thread::get_id());
+        }
+
+        //Gives up wip, draining again for every signal that came in meanwhile.
+        void leave(int missed)
+        {
+            while(true)
+            {
+                drainingThread.store(std::thread::id());
+                missed = wip.fetch_sub(missed) - missed;
+                if(missed == 0)
+                {
+                    return;
+                }
+                enter();
+                drainOnce();
+            }
+        }
+
+        //Runs on the thread owning wip only.
+        void drainOnce()
+        {
+            if(done)
+            {
+                return;
+            }
+
+            if(this->isUnsubscribe())
+            {
+                done = true;
+                active.clear();
+                return;
+            }
+
+            if(errorReady.load())
+            {
+                done = true;
+                this->child->onError(error);
+                this->unsubscribe();
+                active.clear();
+                return;
+            }
+
+            for(size_t i = 0; i < active.size();)
+            {
+                InnerPtrType inner = active[i];
+                bool innerDone = inner->done.load();
+                R r;
+                while(!done && inner->queue.tryPop(r))
+                {
+                    --inner->queued;
+                    this->child->onNext(r);
+                }
+
+                if(innerDone && inner->queued.load() == 0)
+                {
+                    std::swap(active[i], active.back());
+                    active.pop_back();
+                    this->remove(inner);
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+
+            T t;
+            while(active.size() < maxConcurrency && sources.tryPop(t))
+            {
+                subscribeInner(t);
+            }
+
+            if(parentComplete.load() && sources.empty() && active.empty() && !errorReady.load())
             {
                 done = true;
                 this->child->onComplete();
             }
         }
 
+        void subscribeInner(const T& t)
+        {
+            MapObservableType mapped = mapper(t);
+            //Synchronous inners are pulled inline, no inner subscriber needed.
+            if(mapped.isSynchronous())
+            {
+                mapped.drainSync([this](const R& r){
+                    this->child->onNext(r);
+                    return !this->isUnsubscribe();
+                });
+                return;
+            }
+
+            auto obs = std::make_shared<MapObservableType>(std::move(mapped));
+            InnerPtrType innerSubscriber = std::make_shared<InnerFlatMapSubscriber>
+                    (std::static_pointer_cast<FlatMapSubscriber>(this->shared_from_this()));
+
+            active.push_back(innerSubscriber);
+            this->add(innerSubscriber);
+            addObservableReference(obs);
+            obs->subscribe(std::static_pointer_cast<Subscriber<R>>(innerSubscriber));
+        }
+
         void addObservableReference(const std::shared_ptr<MapObservableType>& obs)
         {
             pool.push_back(obs);
         }
 
         MapperType mapper;
-        std::atomic_int requested;
-        volatile bool parentComplete = false;
-        volatile bool done = false;
+        const size_t maxConcurrency;
+        std::atomic<int> wip;
+        std::atomic<std::thread::id> drainingThread;
+        std::atomic<bool> parentComplete;
+        std::atomic<bool> errorClaimed;
+        std::atomic<bool> errorReady;
+        std::exception_ptr error;
+        MPSCQueue<T> sources;
+        //Owned by the thread holding wip.
+        std::vector<InnerPtrType> active;
+        bool done = false;
         //Keep observable references
         std::vector<std::shared_ptr<MapObservableType>> pool;
     };
 
     struct InnerFlatMapSubscriber : public Subscriber<R>
     {
-        InnerFlatMapSubscriber(std::shared_ptr<FlatMapSubscriber> child) : child(child)
+        InnerFlatMapSubscriber(std::shared_ptr<FlatMapSubscriber> child) : child(child), queued(0), done(false)
         {}
 
         void onNext(const R& t) override
         {
-            child->onNextInner(t);
+            child->onNextInner(this, t);
         }
 
         void onError(std::exception_ptr ex) override
@@ -97,18 +269,24 @@ public:
 
         void onComplete() override
         {
+            done.store(true);
             child->onCompleteInner();
         }
 
         std::shared_ptr<FlatMapSubscriber> child;
+        MPSCQueue<R> queue;
+        std::atomic<size_t> queued;
+        std::atomic<bool> done;
     };
 
-    OnSubscribeFlatMap(OnSubscribePtrType source, const MapperType& mapper) : source(source)
-      ,mapper(mapper)
+    OnSubscribeFlatMap(OnSubscribePtrType source, const MapperType& mapper,
+                       size_t maxConcurrency = std::numeric_limits<size_t>::max()) : source(source)
+      ,mapper(mapper), maxConcurrency(std::max<size_t>(maxConcurrency, 1))
     {}
 
-    OnSubscribeFlatMap(OnSubscribePtrType source, MapperType&& mapper) : source(source)
-      ,mapper(std::move(mapper))
+    OnSubscribeFlatMap(OnSubscribePtrType source, MapperType&& mapper,
+                       size_t maxConcurrency = std::numeric_limits<size_t>::max()) : source(source)
+      ,mapper(std::move(mapper)), maxConcurrency(std::max<size_t>(maxConcurrency, 1))
     {}
 
     void operator()(const SubscriberPtrType<R>& s) override
@@ -118,7 +296,7 @@ public:
             return;
         }
 
-        std::shared_ptr<FlatMapSubscriber> parent = std::make_shared<FlatMapSubscriber>(s, mapper);
+        std::shared_ptr<FlatMapSubscriber> parent = std::make_shared<FlatMapSubscriber>(s, mapper, maxConcurrency);
         s->add(parent);
 
         if(!s->isUnsubscribe())
@@ -130,6 +308,7 @@ public:
 private:
     OnSubscribePtrType source;
     MapperType mapper;
+    size_t maxConcurrency;
 };
 
 
@@ -0,0 +1,719 @@
+#ifndef ONSUBSCRIBEPARALLEL_HPP
+#define ONSUBSCRIBEPARALLEL_HPP
+#include "OnSubscribeBase.hpp"
+#include "Operator.hpp"
+#include "OperatorSerialize.hpp"
+#include "../Scheduler.hpp"
+#include "../utils/MPSCQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+//Value travelling on a rail together with its position in the source. Values
+//rejected by a rail filter stay on the rail as invalid markers, so an ordered
+//merge never waits for an index that will not come.
+template<typename T>
+struct Sequenced
+{
+    Sequenced() : index(0), valid(false), value()
+    {}
+
+    Sequenced(size_t index) : index(index), valid(false), value()
+    {}
+
+    Sequenced(size_t index, const T& value) : index(index), valid(true), value(value)
+    {}
+
+    size_t index;
+    bool valid;
+    T value;
+};
+
+template<typename T>
+using RailSubscriberPtrType = SubscriberPtrType<Sequenced<T>>;
+
+//Subscribes one subscriber per rail.
+template<typename T>
+class ParallelOnSubscribeBase
+{
+public:
+    virtual ~ParallelOnSubscribeBase() = default;
+
+    virtual size_t rails() const = 0;
+
+    virtual void operator()(const std::vector<RailSubscriberPtrType<T>>& subscribers) = 0;
+};
+
+//Splits the source onto the rails, by a key hash or round-robin. Every rail
+//queues its values and drains them on its own worker, one scheduled drain
+//per burst instead of one per value.
+template<typename T>
+class ParallelSourceOnSubscribe : public ParallelOnSubscribeBase<T>
+{
+public:
+    using OnSubscribePtrType = std::shared_ptr<OnSubscribeBase<T>>;
+    using RailSelectorType   = std::function<size_t(const T&)>;
+
+    ParallelSourceOnSubscribe(OnSubscribePtrType source, size_t rails,
+                              const Scheduler::SchedulerRefType& scheduler,
+                              RailSelectorType railSelector) :
+        source(source), railsCount(std::max<size_t>(rails, 1)), scheduler(scheduler),
+        railSelector(std::move(railSelector))
+    {}
+
+    struct Rail : public std::enable_shared_from_this<Rail>
+    {
+        Rail(const RailSubscriberPtrType<T>& child, Scheduler::WorkerRefType worker) :
+            child(child), worker(std::move(worker)), wip(0), terminated(false), delivered(false)
+        {}
+
+        void push(Sequenced<T>&& v)
+        {
+            queue.push(std::move(v));
+            schedule();
+        }
+
+        void terminate(std::exception_ptr ex)
+        {
+            error = ex;
+            terminated.store(true);
+            schedule();
+        }
+
+        void schedule()
+        {
+            if(wip.fetch_add(1) == 0)
+            {
+                auto self = this->shared_from_this();
+                worker->schedule(std::make_shared<Action0>([self](){
+                    self->drain();
+                }));
+            }
+        }
+
+        void drain()
+        {
+            int missed = 1;
+            while(true)
+            {
+                Sequenced<T> v;
+                while(!child->isUnsubscribe() && queue.tryPop(v))
+                {
+                    child->onNext(v);
+                }
+
+                if(terminated.load() && queue.empty() && !delivered)
+                {
+                    delivered = true;
+                    if(error)
+                    {
+                        child->onError(error);
+                    }
+                    else
+                    {
+                        child->onComplete();
+                    }
+                }
+
+                missed = wip.fetch_sub(missed) - missed;
+                if(missed == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        RailSubscriberPtrType<T> child;
+        Scheduler::WorkerRefType worker;
+        MPSCQueue<Sequenced<T>> queue;
+        std::atomic<int> wip;
+        std::atomic<bool> terminated;
+        std::exception_ptr error;
+        //Only touched by the draining thread.
+        bool delivered;
+    };
+
+    struct DispatchSubscriber : public Subscriber<T>
+    {
+        DispatchSubscriber(const RailSelectorType& railSelector) :
+            railSelector(railSelector), index(0)
+        {}
+
+        void onNext(const T& t) override
+        {
+            size_t rail = railSelector ? railSelector(t) % rails.size() : index % rails.size();
+            rails[rail]->push(Sequenced<T>(index++, t));
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            for(auto& rail : rails)
+            {
+                rail->terminate(ex);
+            }
+        }
+
+        void onComplete() override
+        {
+            for(auto& rail : rails)
+            {
+                rail->terminate(nullptr);
+            }
+        }
+
+        RailSelectorType railSelector;
+        std::vector<std::shared_ptr<Rail>> rails;
+        size_t index;
+    };
+
+    size_t rails() const override
+    {
+        return railsCount;
+    }
+
+    void operator()(const std::vector<RailSubscriberPtrType<T>>& subscribers) override
+    {
+        auto dispatcher = std::make_shared<DispatchSubscriber>(railSelector);
+        for(size_t i = 0; i < subscribers.size(); ++i)
+        {
+            dispatcher->rails.push_back(std::make_shared<Rail>(subscribers[i], scheduler->createWorkerForKey(i)));
+            subscribers[i]->add(dispatcher);
+        }
+        (*source)(dispatcher);
+    }
+
+private:
+    OnSubscribePtrType source;
+    size_t railsCount;
+    Scheduler::SchedulerRefType scheduler;
+    RailSelectorType railSelector;
+};
+
+//Applies an operator on every rail. The operator is called once per rail, so
+//it must not keep state between calls.
+template<typename A, typename B>
+class ParallelLiftOnSubscribe : public ParallelOnSubscribeBase<A>
+{
+public:
+    ParallelLiftOnSubscribe(std::shared_ptr<ParallelOnSubscribeBase<B>> parent,
+                            std::unique_ptr<Operator<Sequenced<B>, Sequenced<A>>> o) :
+        parent(parent), op(std::move(o))
+    {}
+
+    size_t rails() const override
+    {
+        return parent->rails();
+    }
+
+    void operator()(const std::vector<RailSubscriberPtrType<A>>& subscribers) override
+    {
+        std::vector<RailSubscriberPtrType<B>> parentSubscribers;
+        parentSubscribers.reserve(subscribers.size());
+        for(auto& s : subscribers)
+        {
+            parentSubscribers.push_back((*op)(s));
+        }
+        (*parent)(parentSubscribers);
+    }
+
+private:
+    std::shared_ptr<ParallelOnSubscribeBase<B>> parent;
+    std::unique_ptr<Operator<Sequenced<B>, Sequenced<A>>> op;
+};
+
+//Merges the rails back into one stream, either as values arrive or in the
+//order of the source.
+template<typename T>
+class OnSubscribeSequential : public OnSubscribeBase<T>
+{
+public:
+    using ParallelPtrType = std::shared_ptr<ParallelOnSubscribeBase<T>>;
+
+    OnSubscribeSequential(ParallelPtrType parent, bool ordered) :
+        parent(parent), ordered(ordered)
+    {}
+
+    struct MergeState
+    {
+        MergeState(size_t rails) : remaining(rails)
+        {}
+
+        std::atomic<size_t> remaining;
+    };
+
+    //Rails run concurrently, the child sees them through a SerializedSubscriber.
+    struct UnorderedRailSubscriber : public Subscriber<Sequenced<T>>
+    {
+        UnorderedRailSubscriber(const std::shared_ptr<SerializedSubscriber<T>>& child,
+                                const std::shared_ptr<MergeState>& state) :
+            child(child), state(state)
+        {}
+
+        void onNext(const Sequenced<T>& t) override
+        {
+            if(t.valid)
+            {
+                child->onNext(t.value);
+            }
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            child->onError(ex);
+            child->unsubscribe();
+        }
+
+        void onComplete() override
+        {
+            if(--state->remaining == 0)
+            {
+                child->onComplete();
+            }
+        }
+
+        std::shared_ptr<SerializedSubscriber<T>> child;
+        std::shared_ptr<MergeState> state;
+    };
+
+    //Collects the rails' values in a lock-free queue; the thread holding wip
+    //moves them into a heap and emits the run of consecutive indices.
+    struct OrderedMerger : public CompositeSubscriber<T,T>
+    {
+        OrderedMerger(const SubscriberPtrType<T>& child, size_t rails) :
+            CompositeSubscriber<T,T>(child), remaining(rails), wip(0),
+            errorClaimed(false), errorReady(false), next(0), done(false)
+        {}
+
+        void onNext(const T&) override
+        {}
+
+        void onNextRail(const Sequenced<T>& t)
+        {
+            incoming.push(t);
+            signal();
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            if(!errorClaimed.exchange(true))
+            {
+                error = ex;
+                errorReady.store(true);
+            }
+            signal();
+        }
+
+        void onComplete() override
+        {
+            --remaining;
+            signal();
+        }
+
+        void signal()
+        {
+            if(wip.fetch_add(1) != 0)
+            {
+                return;
+            }
+            int missed = 1;
+            while(true)
+            {
+                drainOnce();
+                missed = wip.fetch_sub(missed) - missed;
+                if(missed == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        void drainOnce()
+        {
+            if(done)
+            {
+                return;
+            }
+            if(errorReady.load())
+            {
+                done = true;
+                this->child->onError(error);
+                this->unsubscribe();
+                return;
+            }
+
+            bool railsDone = remaining.load() == 0;
+            Sequenced<T> t;
+            while(incoming.tryPop(t))
+            {
+                pending.push(t);
+            }
+            while(!pending.empty() && pending.top().index == next && !this->isUnsubscribe())
+            {
+                if(pending.top().valid)
+                {
+                    this->child->onNext(pending.top().value);
+                }
+                pending.pop();
+                ++next;
+            }
+
+            if(railsDone && incoming.empty() && pending.empty())
+            {
+                done = true;
+                this->child->onComplete();
+            }
+        }
+
+        struct Later
+        {
+            bool operator()(const Sequenced<T>& a, const Sequenced<T>& b) const
+            {
+                return a.index > b.index;
+            }
+        };
+
+        std::atomic<size_t> remaining;
+        std::atomic<int> wip;
+        std::atomic<bool> errorClaimed;
+        std::atomic<bool> errorReady;
+        std::exception_ptr error;
+        MPSCQueue<Sequenced<T>> incoming;
+        //Only touched by the thread holding wip.
+        std::priority_queue<Sequenced<T>, std::vector<Sequenced<T>>, Later> pending;
+        size_t next;
+        bool done;
+    };
+
+    struct OrderedRailSubscriber : public Subscriber<Sequenced<T>>
+    {
+        OrderedRailSubscriber(const std::shared_ptr<OrderedMerger>& merger) : merger(merger)
+        {}
+
+        void onNext(const Sequenced<T>& t) override
+        {
+            merger->onNextRail(t);
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            merger->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            merger->onComplete();
+        }
+
+        std::shared_ptr<OrderedMerger> merger;
+    };
+
+    void operator()(const SubscriberPtrType<T>& s) override
+    {
+        if(s == nullptr)
+        {
+            return;
+        }
+
+        size_t rails = parent->rails();
+        std::vector<RailSubscriberPtrType<T>> subscribers;
+        if(ordered)
+        {
+            auto merger = std::make_shared<OrderedMerger>(s, rails);
+            merger->addChildSubscriptionFromThis();
+            for(size_t i = 0; i < rails; ++i)
+            {
+                subscribers.push_back(std::make_shared<OrderedRailSubscriber>(merger));
+                merger->add(subscribers.back());
+            }
+        }
+        else
+        {
+            auto serialized = std::make_shared<SerializedSubscriber<T>>(s);
+            serialized->addChildSubscriptionFromThis();
+            auto state = std::make_shared<MergeState>(rails);
+            for(size_t i = 0; i < rails; ++i)
+            {
+                subscribers.push_back(std::make_shared<UnorderedRailSubscriber>(serialized, state));
+                serialized->add(subscribers.back());
+            }
+        }
+
+        if(!s->isUnsubscribe())
+        {
+            (*parent)(subscribers);
+        }
+    }
+
+private:
+    ParallelPtrType parent;
+    bool ordered;
+};
+
+//Reduces every rail on its own thread, then combines the rails' partial
+//results with the same accumulator. The accumulator must be associative and
+//commutative. Emits nothing for an empty source.
+template<typename T, typename Accumulator>
+class OnSubscribeParallelReduce : public OnSubscribeBase<T>
+{
+public:
+    using ParallelPtrType = std::shared_ptr<ParallelOnSubscribeBase<T>>;
+    using AccumulatorType = typename std::decay<Accumulator>::type;
+
+    OnSubscribeParallelReduce(ParallelPtrType parent, const AccumulatorType& accumulator) :
+        parent(parent), accumulator(accumulator)
+    {}
+
+    OnSubscribeParallelReduce(ParallelPtrType parent, AccumulatorType&& accumulator) :
+        parent(parent), accumulator(std::move(accumulator))
+    {}
+
+    struct ReduceState : public CompositeSubscriber<T,T>
+    {
+        ReduceState(const SubscriberPtrType<T>& child, const AccumulatorType& accumulator, size_t rails) :
+            CompositeSubscriber<T,T>(child), accumulator(accumulator), remaining(rails),
+            hasValue(false), failed(false)
+        {}
+
+        void onNext(const T&) override
+        {}
+
+        void onError(std::exception_ptr ex) override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            if(failed)
+            {
+                return;
+            }
+            failed = true;
+            this->child->onError(ex);
+            this->unsubscribe();
+        }
+
+        void onComplete() override
+        {}
+
+        void onRailComplete(bool railHasValue, const T& partial)
+        {
+            std::lock_guard<std::mutex> l(lock);
+            if(failed)
+            {
+                return;
+            }
+            if(railHasValue)
+            {
+                value = hasValue ? accumulator(value, partial) : partial;
+                hasValue = true;
+            }
+            if(--remaining == 0)
+            {
+                if(hasValue)
+                {
+                    this->child->onNext(value);
+                }
+                this->child->onComplete();
+            }
+        }
+
+        AccumulatorType accumulator;
+        std::mutex lock;
+        size_t remaining;
+        bool hasValue;
+        bool failed;
+        T value;
+    };
+
+    struct RailReduceSubscriber : public Subscriber<Sequenced<T>>
+    {
+        RailReduceSubscriber(const std::shared_ptr<ReduceState>& state, const AccumulatorType& accumulator) :
+            state(state), accumulator(accumulator), hasValue(false)
+        {}
+
+        void onNext(const Sequenced<T>& t) override
+        {
+            if(!t.valid)
+            {
+                return;
+            }
+            partial = hasValue ? accumulator(partial, t.value) : t.value;
+            hasValue = true;
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            state->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            state->onRailComplete(hasValue, partial);
+        }
+
+        std::shared_ptr<ReduceState> state;
+        AccumulatorType accumulator;
+        bool hasValue;
+        T partial;
+    };
+
+    void operator()(const SubscriberPtrType<T>& s) override
+    {
+        if(s == nullptr)
+        {
+            return;
+        }
+
+        size_t rails = parent->rails();
+        auto state = std::make_shared<ReduceState>(s, accumulator, rails);
+        state->addChildSubscriptionFromThis();
+        std::vector<RailSubscriberPtrType<T>> subscribers;
+        for(size_t i = 0; i < rails; ++i)
+        {
+            subscribers.push_back(std::make_shared<RailReduceSubscriber>(state, accumulator));
+            state->add(subscribers.back());
+        }
+
+        if(!s->isUnsubscribe())
+        {
+            (*parent)(subscribers);
+        }
+    }
+
+private:
+    ParallelPtrType parent;
+    AccumulatorType accumulator;
+};
+
+//Collects every rail into a container made by the supplier, then folds the
+//rails' containers into the first one with the combiner. Each rail owns its
+//container, so collecting takes no lock.
+template<typename T, typename C, typename Supplier, typename Collector, typename Combiner>
+class OnSubscribeParallelCollect : public OnSubscribeBase<C>
+{
+public:
+    using ParallelPtrType = std::shared_ptr<ParallelOnSubscribeBase<T>>;
+    using SupplierType    = typename std::decay<Supplier>::type;
+    using CollectorType   = typename std::decay<Collector>::type;
+    using CombinerType    = typename std::decay<Combiner>::type;
+
+    OnSubscribeParallelCollect(ParallelPtrType parent, const SupplierType& supplier,
+                               const CollectorType& collector, const CombinerType& combiner) :
+        parent(parent), supplier(supplier), collector(collector), combiner(combiner)
+    {}
+
+    struct CollectState : public CompositeSubscriber<C,C>
+    {
+        CollectState(const SubscriberPtrType<C>& child, const CombinerType& combiner, size_t rails) :
+            CompositeSubscriber<C,C>(child), combiner(combiner), remaining(rails), hasValue(false), failed(false)
+        {}
+
+        void onNext(const C&) override
+        {}
+
+        void onError(std::exception_ptr ex) override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            if(failed)
+            {
+                return;
+            }
+            failed = true;
+            this->child->onError(ex);
+            this->unsubscribe();
+        }
+
+        void onComplete() override
+        {}
+
+        void onRailComplete(C& partial)
+        {
+            std::lock_guard<std::mutex> l(lock);
+            if(failed)
+            {
+                return;
+            }
+            if(hasValue)
+            {
+                combiner(value, partial);
+            }
+            else
+            {
+                value = std::move(partial);
+                hasValue = true;
+            }
+            if(--remaining == 0)
+            {
+                this->child->onNext(value);
+                this->child->onComplete();
+            }
+        }
+
+        CombinerType combiner;
+        std::mutex lock;
+        size_t remaining;
+        bool hasValue;
+        bool failed;
+        C value;
+    };
+
+    struct RailCollectSubscriber : public Subscriber<Sequenced<T>>
+    {
+        RailCollectSubscriber(const std::shared_ptr<CollectState>& state, const CollectorType& collector, C partial) :
+            state(state), collector(collector), partial(std::move(partial))
+        {}
+
+        void onNext(const Sequenced<T>& t) override
+        {
+            if(t.valid)
+            {
+                collector(partial, t.value);
+            }
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            state->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            state->onRailComplete(partial);
+        }
+
+        std::shared_ptr<CollectState> state;
+        CollectorType collector;
+        C partial;
+    };
+
+    void operator()(const SubscriberPtrType<C>& s) override
+    {
+        if(s == nullptr)
+        {
+            return;
+        }
+
+        size_t rails = parent->rails();
+        auto state = std::make_shared<CollectState>(s, combiner, rails);
+        state->addChildSubscriptionFromThis();
+        std::vector<RailSubscriberPtrType<T>> subscribers;
+        for(size_t i = 0; i < rails; ++i)
+        {
+            subscribers.push_back(std::make_shared<RailCollectSubscriber>(state, collector, supplier()));
+            state->add(subscribers.back());
+        }
+
+        if(!s->isUnsubscribe())
+        {
+            (*parent)(subscribers);
+        }
+    }
+
+private:
+    ParallelPtrType parent;
+    SupplierType supplier;
+    CollectorType collector;
+    CombinerType combiner;
+};
+
+#endif // ONSUBSCRIBEPARALLEL_HPP
@@ -0,0 +1,156 @@
+#ifndef ONSUBSCRIBERETRY_HPP
+#define ONSUBSCRIBERETRY_HPP
+#include "OnSubscribeBase.hpp"
+#include "../Scheduler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <type_traits>
+
+//Resubscribes to the source after an error. The handler is called with the
+//error and the number of the failed attempt (from 1) and returns the delay
+//before the next attempt; a negative delay, or an exception thrown by the
+//handler, ends the retries and the error goes to the child. Every attempt gets
+//a fresh subscriber and resubscription happens on the worker once the delay has
+//passed on the shared timer, so no thread waits and the stack does not grow.
+template<typename T, typename Handler>
+class OnSubscribeRetry : public OnSubscribeBase<T>
+{
+public:
+    using OnSubscribePtrType  = std::shared_ptr<OnSubscribeBase<T>>;
+    using ChildSubscriberType = typename CompositeSubscriber<T,T>::ChildSubscriberType;
+    using HandlerType         = typename std::decay<Handler>::type;
+
+    struct RetryState : public std::enable_shared_from_this<RetryState>
+    {
+        RetryState(ChildSubscriberType child, const OnSubscribePtrType& source, const HandlerType& handler,
+                   const Scheduler::SchedulerRefType& scheduler) :
+            child(child), source(source), handler(handler), worker(scheduler->createWorker()), attempt(0)
+        {}
+
+        void subscribeNext()
+        {
+            if(child->isUnsubscribe())
+            {
+                return;
+            }
+            auto subscriber = std::make_shared<AttemptSubscriber>(this->shared_from_this());
+            child->add(subscriber);
+            (*source)(subscriber);
+        }
+
+        void failed(const SubscriptionPtrType& subscriber, std::exception_ptr ex)
+        {
+            child->remove(subscriber);
+
+            std::chrono::steady_clock::duration delay;
+            try
+            {
+                delay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(handler(ex, ++attempt));
+            }
+            catch(...)
+            {
+                child->onError(std::current_exception());
+                return;
+            }
+
+            if(delay < std::chrono::steady_clock::duration::zero() || child->isUnsubscribe())
+            {
+                child->onError(ex);
+                return;
+            }
+
+            auto self = this->shared_from_this();
+            if(pending != nullptr)
+            {
+                child->remove(pending);
+            }
+            pending = worker->scheduleDelayed(std::make_shared<Action0>([self](){
+                self->subscribeNext();
+            }), delay);
+            child->add(pending);
+        }
+
+        ChildSubscriberType child;
+        OnSubscribePtrType source;
+        HandlerType handler;
+        Scheduler::WorkerRefType worker;
+        //Attempts follow each other, only one thread touches these at a time.
+        size_t attempt;
+        SubscriptionPtrType pending;
+    };
+
+    struct AttemptSubscriber : public CompositeSubscriber<T,T>
+    {
+        AttemptSubscriber(std::shared_ptr<RetryState> state) : CompositeSubscriber<T,T>(state->child), state(state)
+        {}
+
+        void onNext(const T& t) override
+        {
+            this->child->onNext(t);
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            this->unsubscribe();
+            state->failed(this->shared_from_this(), ex);
+        }
+
+        std::shared_ptr<RetryState> state;
+    };
+
+    OnSubscribeRetry(const OnSubscribePtrType& source, const HandlerType& handler,
+                     const Scheduler::SchedulerRefType& scheduler) :
+        source(source), handler(handler), scheduler(scheduler)
+    {}
+
+    void operator()(const SubscriberPtrType<T>& subscriber) override
+    {
+        if(subscriber == nullptr)
+        {
+            return;
+        }
+        std::make_shared<RetryState>(subscriber, source, handler, scheduler)->subscribeNext();
+    }
+
+private:
+    OnSubscribePtrType source;
+    HandlerType handler;
+    Scheduler::SchedulerRefType scheduler;
+};
+
+//Handler for retry(): at most maxRetries attempts, the delay starting at
+//initialDelay and growing by multiplier, each one spread randomly by up to
+//jitter of itself.
+struct ExponentialBackoff
+{
+    ExponentialBackoff(size_t maxRetries, std::chrono::steady_clock::duration initialDelay,
+                       double multiplier, double jitter) :
+        maxRetries(maxRetries), initialDelay(initialDelay), multiplier(multiplier),
+        jitter(std::min(std::max(jitter, 0.0), 1.0))
+    {}
+
+    std::chrono::steady_clock::duration operator()(std::exception_ptr, size_t attempt) const
+    {
+        if(attempt > maxRetries)
+        {
+            return std::chrono::steady_clock::duration(-1);
+        }
+        double delay = initialDelay.count() * std::pow(multiplier, static_cast<double>(attempt - 1));
+        if(jitter > 0)
+        {
+            static thread_local std::minstd_rand random(std::random_device{}());
+            std::uniform_real_distribution<double> spread(1.0 - jitter, 1.0 + jitter);
+            delay *= spread(random);
+        }
+        return std::chrono::steady_clock::duration(static_cast<std::chrono::steady_clock::rep>(delay));
+    }
+
+    size_t maxRetries;
+    std::chrono::steady_clock::duration initialDelay;
+    double multiplier;
+    double jitter;
+};
+
+#endif // ONSUBSCRIBERETRY_HPP
@@ -0,0 +1,204 @@
+#ifndef ONSUBSCRIBESWITCHMAP_HPP
+#define ONSUBSCRIBESWITCHMAP_HPP
+
+#include "OnSubscribeBase.hpp"
+#include "OperatorSerialize.hpp"
+#include <atomic>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//Maps every value to an observable and mirrors only the latest one: a new
+//upstream value unsubscribes the previous inner. Each inner carries the
+//generation it was created for and its values travel tagged with it; the
+//generation is checked again once a value leaves the serializer, so late
+//emissions of cancelled inners are dropped without a lock.
+template<typename T, typename R, typename Mapper>
+class OnSubscribeSwitchMap : public OnSubscribeBase<R>
+{
+public:
+    using OnSubscribePtrType      = std::shared_ptr<OnSubscribeBase<T>>;
+    using MapperType              = typename std::decay<Mapper>::type;
+    using ThisChildSubscriberType = typename CompositeSubscriber<T,R>::ChildSubscriberType;
+    using MapObservableType       = typename std::result_of<MapperType(const T&)>::type;
+    using TaggedType              = std::pair<size_t, R>;
+    using GenerationRefType       = std::shared_ptr<std::atomic<size_t>>;
+
+    struct InnerSwitchMapSubscriber;
+
+    //Last stop after the serializer: values of superseded generations go no further.
+    struct GenerationGate : public CompositeSubscriber<TaggedType,R>
+    {
+        GenerationGate(ThisChildSubscriberType child, const GenerationRefType& generation) :
+            CompositeSubscriber<TaggedType,R>(child), generation(generation)
+        {}
+
+        void onNext(const TaggedType& tagged) override
+        {
+            if(generation->load() == tagged.first)
+            {
+                this->child->onNext(tagged.second);
+            }
+        }
+
+        GenerationRefType generation;
+    };
+
+    struct SwitchMapSubscriber : public CompositeSubscriber<T,TaggedType>
+    {
+        SwitchMapSubscriber(const std::shared_ptr<Subscriber<TaggedType>>& child, const MapperType& mapper,
+                            const GenerationRefType& generation) :
+            CompositeSubscriber<T,TaggedType>(child), mapper(mapper), generation(generation),
+            completedGeneration(0), parentComplete(false), completed(false)
+        {}
+
+        void onNext(const T& t) override
+        {
+            if(this->isUnsubscribe())
+            {
+                return;
+            }
+
+            size_t gen = ++*generation;
+            if(current != nullptr)
+            {
+                current->unsubscribe();
+                this->remove(current);
+            }
+
+            auto obs = std::make_shared<MapObservableType>(std::move(mapper(t)));
+            current = std::make_shared<InnerSwitchMapSubscriber>
+                    (std::static_pointer_cast<SwitchMapSubscriber>(this->shared_from_this()), gen);
+            current->observable = obs;
+            this->add(current);
+            obs->subscribe(std::static_pointer_cast<Subscriber<R>>(current));
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            this->child->onError(ex);
+            this->unsubscribe();
+        }
+
+        void onComplete() override
+        {
+            parentComplete.store(true);
+            if(completedGeneration.load() == generation->load())
+            {
+                complete();
+            }
+        }
+
+        bool isCurrent(size_t gen) const
+        {
+            return generation->load() == gen;
+        }
+
+        void onNextInner(size_t gen, const R& r)
+        {
+            this->child->onNext(TaggedType(gen, r));
+        }
+
+        //Cancelled inners completing late must not mask the current one.
+        void onCompleteInner(size_t gen)
+        {
+            if(!isCurrent(gen))
+            {
+                return;
+            }
+            completedGeneration.store(gen);
+            if(isCurrent(gen) && parentComplete.load())
+            {
+                complete();
+            }
+        }
+
+        //Upstream and the current inner may both see the other one done.
+        void complete()
+        {
+            if(!completed.exchange(true))
+            {
+                this->child->onComplete();
+            }
+        }
+
+        MapperType mapper;
+        GenerationRefType generation;
+        std::atomic<size_t> completedGeneration;
+        std::atomic<bool> parentComplete;
+        std::atomic<bool> completed;
+        //Touched by the upstream thread only.
+        std::shared_ptr<InnerSwitchMapSubscriber> current;
+    };
+
+    struct InnerSwitchMapSubscriber : public Subscriber<R>
+    {
+        InnerSwitchMapSubscriber(std::shared_ptr<SwitchMapSubscriber> parent, size_t gen) :
+            parent(parent), gen(gen)
+        {}
+
+        void onNext(const R& r) override
+        {
+            if(!parent->isCurrent(gen))
+            {
+                this->unsubscribe();
+                return;
+            }
+            parent->onNextInner(gen, r);
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            if(parent->isCurrent(gen))
+            {
+                parent->onError(ex);
+            }
+        }
+
+        void onComplete() override
+        {
+            parent->onCompleteInner(gen);
+        }
+
+        std::shared_ptr<SwitchMapSubscriber> parent;
+        const size_t gen;
+        //Keep observable reference
+        std::shared_ptr<MapObservableType> observable;
+    };
+
+    OnSubscribeSwitchMap(OnSubscribePtrType source, const MapperType& mapper) :
+        source(source), mapper(mapper)
+    {}
+
+    OnSubscribeSwitchMap(OnSubscribePtrType source, MapperType&& mapper) :
+        source(source), mapper(std::move(mapper))
+    {}
+
+    void operator()(const SubscriberPtrType<R>& s) override
+    {
+        if(s == nullptr)
+        {
+            return;
+        }
+
+        //Inners of different generations may emit from different threads at once.
+        auto generation = std::make_shared<std::atomic<size_t>>(0);
+        auto gate = std::make_shared<GenerationGate>(s, generation);
+        gate->addChildSubscriptionFromThis();
+        auto serialized = std::make_shared<SerializedSubscriber<TaggedType>>(gate);
+        serialized->addChildSubscriptionFromThis();
+        auto parent = std::make_shared<SwitchMapSubscriber>(serialized, mapper, generation);
+        serialized->add(parent);
+
+        if(!s->isUnsubscribe())
+        {
+            (*source)(parent);
+        }
+    }
+
+private:
+    OnSubscribePtrType source;
+    MapperType mapper;
+};
+
+#endif // ONSUBSCRIBESWITCHMAP_HPP
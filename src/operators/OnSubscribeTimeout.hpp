@@ -0,0 +1,170 @@
+#ifndef ONSUBSCRIBETIMEOUT_HPP
+#define ONSUBSCRIBETIMEOUT_HPP
+#include "OnSubscribeBase.hpp"
+#include "../Scheduler.hpp"
+#include "../exceptions/TRExceptions.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+//Fails with TimeoutException, or switches to the fallback, when no value
+//arrives within timeout of the subscription or of the previous value. A value
+//costs a clock read and two atomic updates: one timer per subscription stays
+//armed and, when it fires early, re-arms itself for the last arrival plus
+//timeout. The index is odd while a value is being emitted, so the timeout
+//counts from the end of the emission; a terminated subscription holds the
+//maximum index and cancels its timer.
+template<typename T>
+class OnSubscribeTimeout : public OnSubscribeBase<T>
+{
+public:
+    using OnSubscribePtrType = std::shared_ptr<OnSubscribeBase<T>>;
+    using ChildSubscriberType = typename CompositeSubscriber<T,T>::ChildSubscriberType;
+    using TicksType           = std::chrono::steady_clock::rep;
+
+    struct FallbackSubscriber : public CompositeSubscriber<T,T>
+    {
+        FallbackSubscriber(ChildSubscriberType child) : CompositeSubscriber<T,T>(child)
+        {}
+
+        void onNext(const T& t) override
+        {
+            this->child->onNext(t);
+        }
+    };
+
+    struct TimeoutSubscriber : public CompositeSubscriber<T,T>
+    {
+        static constexpr uint64_t TERMINATED = std::numeric_limits<uint64_t>::max();
+
+        TimeoutSubscriber(ChildSubscriberType child, const Scheduler::SchedulerRefType& scheduler,
+                          std::chrono::steady_clock::duration timeout, const OnSubscribePtrType& fallback) :
+            CompositeSubscriber<T,T>(child), worker(scheduler->createWorker()), timeout(timeout),
+            fallback(fallback), timer(std::make_shared<SerialSubscription>()), index(0),
+            lastArrival(worker->now().time_since_epoch().count())
+        {}
+
+        void onNext(const T& t) override
+        {
+            uint64_t idx = index.load(std::memory_order_acquire);
+            if(idx == TERMINATED || !index.compare_exchange_strong(idx, idx + 1))
+            {
+                return;
+            }
+            this->child->onNext(t);
+            lastArrival.store(worker->now().time_since_epoch().count(), std::memory_order_relaxed);
+            index.store(idx + 2, std::memory_order_release);
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            if(index.exchange(TERMINATED) != TERMINATED)
+            {
+                timer->unsubscribe();
+                this->child->onError(ex);
+            }
+        }
+
+        void onComplete() override
+        {
+            if(index.exchange(TERMINATED) != TERMINATED)
+            {
+                timer->unsubscribe();
+                this->child->onComplete();
+            }
+        }
+
+        void arm(std::chrono::steady_clock::duration delay)
+        {
+            std::weak_ptr<TimeoutSubscriber> weak =
+                    std::static_pointer_cast<TimeoutSubscriber>(this->shared_from_this());
+            timer->set(worker->scheduleDelayed(std::make_shared<Action0>([weak](){
+                if(auto self = weak.lock())
+                {
+                    self->fire();
+                }
+            }), delay));
+        }
+
+        void fire()
+        {
+            uint64_t idx = index.load(std::memory_order_acquire);
+            if(idx == TERMINATED || this->isUnsubscribe())
+            {
+                return;
+            }
+            if(idx & 1)
+            {
+                arm(timeout);
+                return;
+            }
+            auto due = std::chrono::steady_clock::duration(lastArrival.load(std::memory_order_relaxed)) + timeout;
+            auto now = worker->now().time_since_epoch();
+            if(now < due)
+            {
+                arm(due - now);
+                return;
+            }
+            if(!index.compare_exchange_strong(idx, TERMINATED))
+            {
+                //A value won the race, the next check starts from its arrival.
+                arm(timeout);
+                return;
+            }
+
+            this->unsubscribe();
+            if(fallback == nullptr)
+            {
+                this->child->onError(std::make_exception_ptr(TimeoutException()));
+                return;
+            }
+            auto other = std::make_shared<FallbackSubscriber>(this->child);
+            this->child->add(other);
+            (*fallback)(other);
+        }
+
+        Scheduler::WorkerRefType worker;
+        const std::chrono::steady_clock::duration timeout;
+        OnSubscribePtrType fallback;
+        //Keeps the source alive, see OperatorSubscribeOn.
+        OnSubscribePtrType source;
+        std::shared_ptr<SerialSubscription> timer;
+        std::atomic<uint64_t> index;
+        std::atomic<TicksType> lastArrival;
+    };
+
+    template<typename Rep, typename Period>
+    OnSubscribeTimeout(const OnSubscribePtrType& source, const std::chrono::duration<Rep, Period>& timeout,
+                       const Scheduler::SchedulerRefType& scheduler, const OnSubscribePtrType& fallback = nullptr) :
+        source(source), timeout(std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout)),
+        scheduler(scheduler), fallback(fallback)
+    {}
+
+    void operator()(const SubscriberPtrType<T>& subscriber) override
+    {
+        if(subscriber == nullptr)
+        {
+            return;
+        }
+
+        auto parent = std::make_shared<TimeoutSubscriber>(subscriber, scheduler, timeout, fallback);
+        parent->source = source;
+        parent->add(parent->timer);
+        subscriber->add(parent);
+        parent->arm(timeout);
+
+        if(!subscriber->isUnsubscribe())
+        {
+            (*source)(parent);
+        }
+    }
+
+private:
+    OnSubscribePtrType source;
+    std::chrono::steady_clock::duration timeout;
+    Scheduler::SchedulerRefType scheduler;
+    OnSubscribePtrType fallback;
+};
+
+#endif // ONSUBSCRIBETIMEOUT_HPP
@@ -0,0 +1,342 @@
+#ifndef ONSUBSCRIBEZIP_HPP
+#define ONSUBSCRIBEZIP_HPP
+#include "OnSubscribeBase.hpp"
+#include "../exceptions/TRExceptions.hpp"
+#include "../utils/MPSCQueue.hpp"
+#include "../utils/Util.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+//Shared part of the operators joining several sources: a lock-free queue and a
+//completion flag per source, and one drain loop run by whichever thread holds
+//the work-in-progress counter, so sources on different schedulers never wait
+//for each other. The queues are unbounded unless a bufferSize is given: a
+//synchronous source is queued whole before the next source is subscribed. A
+//source getting more than bufferSize values ahead of the drain fails the whole
+//operator with SlowSubscriberException. Derived supplies
+//drainValues(), and may track arrivals in pushed().
+template<typename Derived, typename R, typename ...T>
+class MultiSourceState : public std::enable_shared_from_this<Derived>
+{
+public:
+    using ChildSubscriberType = std::shared_ptr<Subscriber<R>>;
+    using SourcesType         = std::tuple<std::shared_ptr<OnSubscribeBase<T>>...>;
+    using ValuesType          = std::tuple<T...>;
+    using Indexes             = typename MakeIndexSequence<sizeof...(T)>::type;
+
+    template<size_t I>
+    struct SourceSubscriber : public Subscriber<typename std::tuple_element<I, ValuesType>::type>
+    {
+        using ValueType = typename std::tuple_element<I, ValuesType>::type;
+
+        SourceSubscriber(std::shared_ptr<Derived> state) : state(std::move(state))
+        {}
+
+        void onNext(const ValueType& t) override
+        {
+            state->template push<I>(t);
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            state->fail(ex);
+        }
+
+        void onComplete() override
+        {
+            state->complete(I);
+        }
+
+        std::shared_ptr<Derived> state;
+    };
+
+    MultiSourceState(ChildSubscriberType child, size_t bufferSize) :
+        child(std::move(child)), bufferSize(bufferSize), wip(0), errorClaimed(false), errorReady(false),
+        finished(false)
+    {
+        for(auto& d : done)
+        {
+            d.store(false);
+        }
+        for(auto& q : queued)
+        {
+            q.store(0);
+        }
+    }
+
+    void subscribe(const SourcesType& sources)
+    {
+        //Keeps the sources alive, see OperatorSubscribeOn.
+        keepSources = sources;
+        createSubscribers(Indexes());
+        //The drain may drop inners while sources are still being subscribed.
+        std::vector<SubscriptionPtrType> subscribers = inners;
+        subscribeSources(sources, subscribers, Indexes());
+    }
+
+    template<size_t I>
+    void push(const typename std::tuple_element<I, ValuesType>::type& t)
+    {
+        if(queued[I].fetch_add(1) >= bufferSize)
+        {
+            fail(std::make_exception_ptr(SlowSubscriberException()));
+            return;
+        }
+        std::get<I>(queues).push(t);
+        static_cast<Derived*>(this)->pushed(I);
+        signal();
+    }
+
+    void fail(std::exception_ptr ex)
+    {
+        if(!errorClaimed.exchange(true))
+        {
+            error = ex;
+            errorReady.store(true);
+        }
+        signal();
+    }
+
+    void complete(size_t index)
+    {
+        done[index].store(true);
+        signal();
+    }
+
+protected:
+    void pushed(size_t)
+    {}
+
+    template<size_t I>
+    bool tryPop(typename std::tuple_element<I, ValuesType>::type& value)
+    {
+        if(!std::get<I>(queues).tryPop(value))
+        {
+            return false;
+        }
+        queued[I].fetch_sub(1);
+        return true;
+    }
+
+    void signal()
+    {
+        if(wip.fetch_add(1) != 0)
+        {
+            return;
+        }
+        int missed = 1;
+        while(true)
+        {
+            drain();
+            missed = wip.fetch_sub(missed) - missed;
+            if(missed == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    //Runs on the thread holding wip only.
+    void drain()
+    {
+        if(finished)
+        {
+            return;
+        }
+        if(child->isUnsubscribe())
+        {
+            finish();
+            return;
+        }
+        if(errorReady.load())
+        {
+            finish();
+            child->onError(error);
+            return;
+        }
+        static_cast<Derived*>(this)->drainValues();
+    }
+
+    void finish()
+    {
+        finished = true;
+        for(auto& s : inners)
+        {
+            s->unsubscribe();
+        }
+        inners.clear();
+    }
+
+    void emitError(std::exception_ptr ex)
+    {
+        finish();
+        child->onError(ex);
+    }
+
+    void emitComplete()
+    {
+        finish();
+        child->onComplete();
+    }
+
+    //Source I will not deliver anything more.
+    template<size_t I>
+    bool exhausted()
+    {
+        return done[I].load() && std::get<I>(queues).empty();
+    }
+
+    template<size_t... I>
+    void createSubscribers(IndexSequence<I...>)
+    {
+        auto self = std::static_pointer_cast<Derived>(this->shared_from_this());
+        inners = {std::make_shared<SourceSubscriber<I>>(self)...};
+        for(auto& s : inners)
+        {
+            child->add(s);
+        }
+    }
+
+    template<size_t... I>
+    void subscribeSources(const SourcesType& sources, const std::vector<SubscriptionPtrType>& subscribers,
+                          IndexSequence<I...>)
+    {
+        int expand[] = {0, (subscribeSource<I>(std::get<I>(sources), subscribers[I]), 0)...};
+        (void)expand;
+    }
+
+    template<size_t I>
+    void subscribeSource(const std::shared_ptr<OnSubscribeBase<typename std::tuple_element<I, ValuesType>::type>>& source,
+                         const SubscriptionPtrType& subscriber)
+    {
+        if(!subscriber->isUnsubscribe() && !child->isUnsubscribe())
+        {
+            (*source)(std::static_pointer_cast<SourceSubscriber<I>>(subscriber));
+        }
+    }
+
+    ChildSubscriberType child;
+    const size_t bufferSize;
+    std::tuple<MPSCQueue<T>...> queues;
+    std::array<std::atomic<size_t>, sizeof...(T)> queued;
+    std::array<std::atomic<bool>, sizeof...(T)> done;
+    std::atomic<int> wip;
+    std::atomic<bool> errorClaimed;
+    std::atomic<bool> errorReady;
+    std::exception_ptr error;
+    //Owned by the thread holding wip.
+    bool finished;
+    std::vector<SubscriptionPtrType> inners;
+    SourcesType keepSources;
+};
+
+//Combines the n-th values of all sources. Completes once any source has
+//completed and every value it sent has been combined.
+template<typename R, typename Combiner, typename ...T>
+class OnSubscribeZip : public OnSubscribeBase<R>
+{
+public:
+    using CombinerType = typename std::decay<Combiner>::type;
+    using SourcesType  = std::tuple<std::shared_ptr<OnSubscribeBase<T>>...>;
+
+    class ZipState : public MultiSourceState<ZipState, R, T...>
+    {
+        using Base = MultiSourceState<ZipState, R, T...>;
+        friend Base;
+    public:
+        ZipState(typename Base::ChildSubscriberType child, const CombinerType& combiner, size_t bufferSize) :
+            Base(std::move(child), bufferSize), combiner(combiner)
+        {}
+
+    private:
+        void drainValues()
+        {
+            while(ready(typename Base::Indexes()))
+            {
+                typename Base::ValuesType values;
+                pop(values, typename Base::Indexes());
+                try
+                {
+                    emit(values, typename Base::Indexes());
+                }
+                catch(...)
+                {
+                    this->emitError(std::current_exception());
+                    return;
+                }
+                if(this->finished)
+                {
+                    return;
+                }
+            }
+            if(anyExhausted(typename Base::Indexes()))
+            {
+                this->emitComplete();
+            }
+        }
+
+        template<size_t... I>
+        bool ready(IndexSequence<I...>)
+        {
+            bool available[] = {!std::get<I>(this->queues).empty()...};
+            return std::all_of(std::begin(available), std::end(available), [](bool b){ return b; });
+        }
+
+        template<size_t... I>
+        void pop(typename Base::ValuesType& values, IndexSequence<I...>)
+        {
+            bool popped[] = {this->template tryPop<I>(std::get<I>(values))...};
+            (void)popped;
+        }
+
+        template<size_t... I>
+        void emit(const typename Base::ValuesType& values, IndexSequence<I...>)
+        {
+            this->child->onNext(combiner(std::get<I>(values)...));
+        }
+
+        template<size_t... I>
+        bool anyExhausted(IndexSequence<I...>)
+        {
+            bool exhausted[] = {this->template exhausted<I>()...};
+            return std::any_of(std::begin(exhausted), std::end(exhausted), [](bool b){ return b; });
+        }
+
+        CombinerType combiner;
+    };
+
+    OnSubscribeZip(const CombinerType& combiner, const SourcesType& sources, size_t bufferSize) :
+        combiner(combiner), sources(sources), bufferSize(bufferSize)
+    {}
+
+    void operator()(const SubscriberPtrType<R>& subscriber) override
+    {
+        if(subscriber == nullptr)
+        {
+            return;
+        }
+        std::make_shared<ZipState>(subscriber, combiner, bufferSize)->subscribe(sources);
+    }
+
+private:
+    CombinerType combiner;
+    SourcesType sources;
+    size_t bufferSize;
+};
+
+//Default combiner of zip and combineLatest.
+struct MakeTuple
+{
+    template<typename ...T>
+    std::tuple<T...> operator()(const T&... t) const
+    {
+        return std::tuple<T...>(t...);
+    }
+};
+
+#endif // ONSUBSCRIBEZIP_HPP
@@ -7,4 +7,15 @@
 template<typename R, typename P>
 using Operator = Function1<std::shared_ptr<Subscriber<R>>, std::shared_ptr<Subscriber<P>>>;
 
+//Stateless operators that only transform or drop values. Lifted over a
+//synchronous source they keep it synchronous by applying themselves inline.
+template<typename R, typename P>
+class FusableOperator : public Operator<R, P>
+{
+public:
+    //Passes the result for r, if any, to the consumer and returns false once
+    //the consumer asks to stop.
+    virtual bool applySync(const R& r, const std::function<bool(const P&)>& consumer) = 0;
+};
+
 #endif // OPERATOR_H
@@ -0,0 +1,296 @@
+#ifndef OPERATORBUFFER_HPP
+#define OPERATORBUFFER_HPP
+#include "Operator.hpp"
+#include "../Scheduler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+//Emits vectors of count values, a new one starting every skip values: skip equal
+//to count gives consecutive chunks, a smaller skip overlapping ones and a larger
+//skip drops the values in between. Buffers are reserved up front and left to
+//the child by reference; open buffers are flushed on completion.
+template<typename T>
+class OperatorBuffer : public Operator<T, std::vector<T>>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using BufferType           = std::vector<T>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T, BufferType>::ChildSubscriberType;
+
+    struct BufferSubscriber : public CompositeSubscriber<T, BufferType>
+    {
+        BufferSubscriber(ThisSubscriberType p, size_t count, size_t skip) :
+            CompositeSubscriber<T, BufferType>(p), count(count), skip(skip), index(0)
+        {}
+
+        void onNext(const T& t) override
+        {
+            if(index++ % skip == 0)
+            {
+                buffers.push_back(BufferType());
+                buffers.back().reserve(count);
+            }
+
+            for(auto& buffer : buffers)
+            {
+                buffer.push_back(t);
+            }
+
+            if(!buffers.empty() && buffers.front().size() >= count)
+            {
+                BufferType full(std::move(buffers.front()));
+                buffers.pop_front();
+                this->child->onNext(full);
+            }
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            buffers.clear();
+            this->child->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            while(!buffers.empty() && !this->child->isUnsubscribe())
+            {
+                BufferType rest(std::move(buffers.front()));
+                buffers.pop_front();
+                this->child->onNext(rest);
+            }
+            this->child->onComplete();
+        }
+
+        const size_t count;
+        const size_t skip;
+        size_t index;
+        std::deque<BufferType> buffers;
+    };
+
+public:
+    OperatorBuffer(size_t count, size_t skip) :
+        count(std::max<size_t>(count, 1)), skip(std::max<size_t>(skip, 1))
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<BufferSubscriber>(t, count, skip);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    size_t count;
+    size_t skip;
+};
+
+//Emits a vector once adding the next value would take the sizes of its values
+//past maxSize. A value larger than maxSize on its own gets a vector of its own.
+//The next buffer is reserved for as many values as the previous one held.
+template<typename T, typename SizeFunction>
+class OperatorBufferBySize : public Operator<T, std::vector<T>>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using BufferType           = std::vector<T>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T, BufferType>::ChildSubscriberType;
+    using SizeFunctionType     = typename std::decay<SizeFunction>::type;
+
+    struct BufferBySizeSubscriber : public CompositeSubscriber<T, BufferType>
+    {
+        BufferBySizeSubscriber(ThisSubscriberType p, size_t maxSize, const SizeFunctionType& sizeOf) :
+            CompositeSubscriber<T, BufferType>(p), maxSize(maxSize), sizeOf(sizeOf), size(0)
+        {}
+
+        void onNext(const T& t) override
+        {
+            size_t valueSize = sizeOf(t);
+            if(!buffer.empty() && size + valueSize > maxSize)
+            {
+                emit();
+            }
+            buffer.push_back(t);
+            size += valueSize;
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            buffer.clear();
+            this->child->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            if(!buffer.empty())
+            {
+                emit();
+            }
+            this->child->onComplete();
+        }
+
+        void emit()
+        {
+            BufferType full;
+            full.reserve(buffer.size());
+            full.swap(buffer);
+            size = 0;
+            this->child->onNext(full);
+        }
+
+        const size_t maxSize;
+        SizeFunctionType sizeOf;
+        size_t size;
+        BufferType buffer;
+    };
+
+public:
+    OperatorBufferBySize(size_t maxSize, const SizeFunctionType& sizeOf) :
+        maxSize(maxSize), sizeOf(sizeOf)
+    {}
+
+    OperatorBufferBySize(size_t maxSize, SizeFunctionType&& sizeOf) :
+        maxSize(maxSize), sizeOf(std::move(sizeOf))
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<BufferBySizeSubscriber>(t, maxSize, sizeOf);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    size_t maxSize;
+    SizeFunctionType sizeOf;
+};
+
+//Emits a vector timespan after its first value arrived, or earlier once it holds
+//maxCount values. The timer runs on the shared scheduler timer; a vector closed
+//by time is emitted on the scheduler's worker. Emission happens under the
+//operator's lock, which keeps the vectors in order.
+template<typename T>
+class OperatorBufferWithTime : public Operator<T, std::vector<T>>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using BufferType           = std::vector<T>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T, BufferType>::ChildSubscriberType;
+
+    struct BufferWithTimeSubscriber : public CompositeSubscriber<T, BufferType>
+    {
+        BufferWithTimeSubscriber(ThisSubscriberType p, const Scheduler::SchedulerRefType& scheduler,
+                                 std::chrono::steady_clock::duration timespan, size_t maxCount) :
+            CompositeSubscriber<T, BufferType>(p), worker(scheduler->createWorker()),
+            timespan(timespan), maxCount(maxCount), generation(0), done(false)
+        {}
+
+        void onNext(const T& t) override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            if(done)
+            {
+                return;
+            }
+            if(buffer.empty())
+            {
+                buffer.reserve(std::min<size_t>(maxCount, 1024));
+                armTimer();
+            }
+            buffer.push_back(t);
+            if(buffer.size() >= maxCount)
+            {
+                emit();
+            }
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            done = true;
+            buffer.clear();
+            cancelTimer();
+            this->child->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            done = true;
+            if(!buffer.empty())
+            {
+                emit();
+            }
+            this->child->onComplete();
+        }
+
+        //Weakly referenced and cancelled once its buffer leaves, so buffers closed
+        //by count leave nothing behind on the shared timer.
+        void armTimer()
+        {
+            std::weak_ptr<BufferWithTimeSubscriber> weak =
+                    std::static_pointer_cast<BufferWithTimeSubscriber>(this->shared_from_this());
+            size_t gen = generation;
+            timer = worker->scheduleDelayed(std::make_shared<Action0>([weak, gen](){
+                auto self = weak.lock();
+                if(!self)
+                {
+                    return;
+                }
+                std::lock_guard<std::mutex> l(self->lock);
+                if(!self->done && self->generation == gen && !self->buffer.empty())
+                {
+                    self->emit();
+                }
+            }), timespan);
+        }
+
+        //Called under the lock.
+        void cancelTimer()
+        {
+            if(timer != nullptr)
+            {
+                timer->unsubscribe();
+                timer = nullptr;
+            }
+        }
+
+        //Called under the lock.
+        void emit()
+        {
+            ++generation;
+            cancelTimer();
+            BufferType full;
+            full.swap(buffer);
+            this->child->onNext(full);
+        }
+
+        Scheduler::WorkerRefType worker;
+        const std::chrono::steady_clock::duration timespan;
+        const size_t maxCount;
+        std::mutex lock;
+        BufferType buffer;
+        size_t generation;
+        bool done;
+        SubscriptionPtrType timer;
+    };
+
+public:
+    template<typename Rep, typename Period>
+    OperatorBufferWithTime(const std::chrono::duration<Rep, Period>& timespan, size_t maxCount,
+                           const Scheduler::SchedulerRefType& scheduler) :
+        scheduler(scheduler), timespan(std::chrono::duration_cast<std::chrono::steady_clock::duration>(timespan)),
+        maxCount(std::max<size_t>(maxCount, 1))
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<BufferWithTimeSubscriber>(t, scheduler, timespan, maxCount);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    Scheduler::SchedulerRefType scheduler;
+    std::chrono::steady_clock::duration timespan;
+    size_t maxCount;
+};
+
+#endif // OPERATORBUFFER_HPP
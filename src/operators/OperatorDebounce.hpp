@@ -0,0 +1,129 @@
+#ifndef OPERATORDEBOUNCE_HPP
+#define OPERATORDEBOUNCE_HPP
+#include "Operator.hpp"
+#include "../Scheduler.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+//Emits a value once quiet has passed without a newer one. At most one timer is
+//armed at a time: values only record their arrival, and a timer firing early
+//re-arms itself for the latest arrival plus quiet. The last pending value is
+//emitted on completion, which also cancels the timer.
+template<typename T>
+class OperatorDebounce : public Operator<T,T>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T,T>::ChildSubscriberType;
+    using TimePointType        = std::chrono::steady_clock::time_point;
+
+    struct DebounceSubscriber : public CompositeSubscriber<T,T>
+    {
+        DebounceSubscriber(ThisSubscriberType p, const Scheduler::SchedulerRefType& scheduler,
+                           std::chrono::steady_clock::duration quiet) :
+            CompositeSubscriber<T,T>(p), worker(scheduler->createWorker()), quiet(quiet),
+            timer(std::make_shared<SerialSubscription>()), hasValue(false), armed(false), done(false)
+        {}
+
+        void onNext(const T& t) override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            if(done)
+            {
+                return;
+            }
+            latest = t;
+            hasValue = true;
+            lastArrival = worker->now();
+            if(!armed)
+            {
+                armed = true;
+                arm(quiet);
+            }
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            done = true;
+            hasValue = false;
+            timer->unsubscribe();
+            this->child->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            done = true;
+            timer->unsubscribe();
+            if(hasValue)
+            {
+                hasValue = false;
+                this->child->onNext(latest);
+            }
+            this->child->onComplete();
+        }
+
+        void arm(std::chrono::steady_clock::duration delay)
+        {
+            std::weak_ptr<DebounceSubscriber> weak =
+                    std::static_pointer_cast<DebounceSubscriber>(this->shared_from_this());
+            timer->set(worker->scheduleDelayed(std::make_shared<Action0>([weak](){
+                if(auto self = weak.lock())
+                {
+                    self->fire();
+                }
+            }), delay));
+        }
+
+        void fire()
+        {
+            std::lock_guard<std::mutex> l(lock);
+            if(done || !hasValue || this->isUnsubscribe())
+            {
+                armed = false;
+                return;
+            }
+            TimePointType due = lastArrival + quiet;
+            TimePointType now = worker->now();
+            if(now < due)
+            {
+                arm(due - now);
+                return;
+            }
+            armed = false;
+            hasValue = false;
+            this->child->onNext(latest);
+        }
+
+        Scheduler::WorkerRefType worker;
+        const std::chrono::steady_clock::duration quiet;
+        std::shared_ptr<SerialSubscription> timer;
+        std::mutex lock;
+        T latest;
+        TimePointType lastArrival;
+        bool hasValue;
+        bool armed;
+        bool done;
+    };
+
+public:
+    template<typename Rep, typename Period>
+    OperatorDebounce(const std::chrono::duration<Rep, Period>& quiet,
+                     const Scheduler::SchedulerRefType& scheduler) :
+        scheduler(scheduler), quiet(std::chrono::duration_cast<std::chrono::steady_clock::duration>(quiet))
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<DebounceSubscriber>(t, scheduler, quiet);
+        subs->add(subs->timer);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    Scheduler::SchedulerRefType scheduler;
+    std::chrono::steady_clock::duration quiet;
+};
+
+#endif // OPERATORDEBOUNCE_HPP
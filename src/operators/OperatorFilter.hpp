@@ -3,7 +3,7 @@
 #include "Operator.hpp"
 
 template<typename T, typename Predicate>
-class OperatorFilter : public Operator<T,T>
+class OperatorFilter : public FusableOperator<T,T>
 {
     using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
     using ThisSubscriberType   = typename CompositeSubscriber<T,T>::ChildSubscriberType;
@@ -11,8 +11,8 @@ class OperatorFilter : public Operator<T,T>
 
     struct FilterSubscriber : public CompositeSubscriber<T,T>
     {
-        FilterSubscriber(ThisSubscriberType p, PredicateType&& pred) :
-            CompositeSubscriber<T,T>(p), predicate(std::move(pred))
+        FilterSubscriber(ThisSubscriberType p, const PredicateType& pred) :
+            CompositeSubscriber<T,T>(p), predicate(pred)
         {}
 
         void onNext(const T& t) override
@@ -27,20 +27,25 @@ class OperatorFilter : public Operator<T,T>
     };
 
 public:
-    OperatorFilter(const PredicateType& pred) : Operator<T,T>(),
+    OperatorFilter(const PredicateType& pred) : FusableOperator<T,T>(),
         predicate(pred)
     {}
 
-    OperatorFilter(PredicateType&& pred) : Operator<T,T>(),
+    OperatorFilter(PredicateType&& pred) : FusableOperator<T,T>(),
         predicate(std::move(pred))
     {}
 
     SourceSubscriberType operator()(const ThisSubscriberType& t) override
     {
-        auto subs = std::make_shared<FilterSubscriber>(t, std::move(predicate));
+        auto subs = std::make_shared<FilterSubscriber>(t, predicate);
         subs->addChildSubscriptionFromThis();
         return subs;
     }
+
+    bool applySync(const T& t, const std::function<bool(const T&)>& consumer) override
+    {
+        return !predicate(t) || consumer(t);
+    }
 private:
     PredicateType predicate;
 };
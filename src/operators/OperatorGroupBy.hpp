@@ -0,0 +1,212 @@
+#ifndef OPERATORGROUPBY_HPP
+#define OPERATORGROUPBY_HPP
+#include "Operator.hpp"
+#include "UnicastOnSubscribe.hpp"
+#include "../Scheduler.hpp"
+#include "../utils/OpenAddressingMap.hpp"
+#include <chrono>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+template<typename T>
+class Observable;
+
+template<typename K, typename T>
+class GroupedObservable;
+
+//Splits the stream by key into GroupedObservables, each emitted when its key
+//first shows up and subscribable once. Groups are looked up in an open
+//addressing table. With a scheduler, every group is observed on the worker the
+//scheduler pins to its key hash, so per-key work runs serially while different
+//keys run in parallel. With an idle timeout, groups that got no value for
+//between one and two timeouts are completed and forgotten; a later value with
+//their key opens a new group. Idleness is checked as values arrive, on the
+//scheduler's clock when there is one.
+template<typename T, typename KeySelector>
+class OperatorGroupBy : public Operator<T, GroupedObservable<typename std::decay<
+        typename std::result_of<KeySelector(const T&)>::type>::type, T>>
+{
+public:
+    using KeyType   = typename std::decay<typename std::result_of<KeySelector(const T&)>::type>::type;
+    using GroupType = GroupedObservable<KeyType, T>;
+
+private:
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T, GroupType>::ChildSubscriberType;
+    using SelectorType         = typename std::decay<KeySelector>::type;
+    using GroupSourceType      = std::shared_ptr<UnicastOnSubscribe<T>>;
+    using TimePointType        = std::chrono::steady_clock::time_point;
+
+    //Hands out one given worker, for observeOn() of a pinned group.
+    class WorkerScheduler : public Scheduler
+    {
+    public:
+        WorkerScheduler(WorkerRefType worker) : worker(std::move(worker))
+        {}
+
+        WorkerRefType createWorker() override
+        {
+            return worker;
+        }
+    private:
+        WorkerRefType worker;
+    };
+
+    struct Group
+    {
+        GroupSourceType source;
+        size_t lastSweep = 0;
+    };
+
+    struct GroupBySubscriber : public CompositeSubscriber<T, GroupType>
+    {
+        GroupBySubscriber(ThisSubscriberType p, const SelectorType& selector,
+                          const Scheduler::SchedulerRefType& scheduler, std::chrono::steady_clock::duration idle) :
+            CompositeSubscriber<T, GroupType>(p), selector(selector), scheduler(scheduler),
+            //Only eviction reads the clock; a worker of newThread() would start a thread.
+            clock(scheduler && idle > std::chrono::steady_clock::duration::zero() ? scheduler->createWorker() : nullptr),
+            idle(idle), sweeps(0)
+        {
+            if(evicting())
+            {
+                nextSweep = now() + idle;
+            }
+        }
+
+        void onNext(const T& t) override
+        {
+            if(this->isUnsubscribe())
+            {
+                return;
+            }
+            if(evicting())
+            {
+                sweep();
+            }
+
+            KeyType key = selector(t);
+            GroupSourceType source;
+            if(Group* group = groups.find(key))
+            {
+                group->lastSweep = sweeps;
+                source = group->source;
+            }
+            else
+            {
+                source = open(key);
+            }
+            source->onNext(t);
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            for(auto& source : drop())
+            {
+                source->onError(ex);
+            }
+            this->child->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            for(auto& source : drop())
+            {
+                source->onComplete();
+            }
+            this->child->onComplete();
+        }
+
+        GroupSourceType open(const KeyType& key)
+        {
+            Group group;
+            group.source = std::make_shared<UnicastOnSubscribe<T>>();
+            group.lastSweep = sweeps;
+            GroupSourceType source = group.source;
+            groups.insert(key, std::move(group));
+
+            Observable<T> observable(source);
+            if(scheduler)
+            {
+                auto worker = scheduler->createWorkerForKey(std::hash<KeyType>()(key));
+                observable = observable.observeOn(std::make_shared<WorkerScheduler>(worker));
+            }
+            this->child->onNext(GroupType(key, observable));
+            return source;
+        }
+
+        //Completes the groups untouched since the previous sweep.
+        void sweep()
+        {
+            TimePointType time = now();
+            if(time < nextSweep)
+            {
+                return;
+            }
+            std::vector<GroupSourceType> idleGroups;
+            size_t current = sweeps;
+            groups.eraseIf([&](const KeyType&, Group& group){
+                if(group.lastSweep < current)
+                {
+                    idleGroups.push_back(group.source);
+                    return true;
+                }
+                return false;
+            });
+            ++sweeps;
+            nextSweep = time + idle;
+            for(auto& source : idleGroups)
+            {
+                source->onComplete();
+            }
+        }
+
+        std::vector<GroupSourceType> drop()
+        {
+            std::vector<GroupSourceType> sources;
+            sources.reserve(groups.size());
+            groups.forEach([&](const KeyType&, Group& group){
+                sources.push_back(group.source);
+            });
+            groups.clear();
+            return sources;
+        }
+
+        bool evicting() const
+        {
+            return idle > std::chrono::steady_clock::duration::zero();
+        }
+
+        TimePointType now()
+        {
+            return clock ? clock->now() : std::chrono::steady_clock::now();
+        }
+
+        SelectorType selector;
+        Scheduler::SchedulerRefType scheduler;
+        Scheduler::WorkerRefType clock;
+        const std::chrono::steady_clock::duration idle;
+        OpenAddressingMap<KeyType, Group> groups;
+        size_t sweeps;
+        TimePointType nextSweep;
+    };
+
+public:
+    OperatorGroupBy(const SelectorType& selector, const Scheduler::SchedulerRefType& scheduler = nullptr,
+                    std::chrono::steady_clock::duration idle = std::chrono::steady_clock::duration::zero()) :
+        selector(selector), scheduler(scheduler), idle(idle)
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<GroupBySubscriber>(t, selector, scheduler, idle);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    SelectorType selector;
+    Scheduler::SchedulerRefType scheduler;
+    std::chrono::steady_clock::duration idle;
+};
+
+#endif // OPERATORGROUPBY_HPP
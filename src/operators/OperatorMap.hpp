@@ -4,7 +4,7 @@
 #include <type_traits>
 
 template<typename T, typename Mapper>
-class OperatorMap : public Operator<T, typename std::result_of<Mapper(const T&)>::type>
+class OperatorMap : public FusableOperator<T, typename std::result_of<Mapper(const T&)>::type>
 {
     using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
     using MapResultType        = typename std::result_of<Mapper(const T&)>::type;
@@ -13,8 +13,8 @@ class OperatorMap : public Operator<T, typename std::result_of<Mapper(const T&)>
 
     struct MapSubscriber : public CompositeSubscriber<T,MapResultType>
     {
-        MapSubscriber(ThisSubscriberType p, MapFunctionType&& f) :
-            CompositeSubscriber<T,MapResultType>(p), func(std::move(f))
+        MapSubscriber(ThisSubscriberType p, const MapFunctionType& f) :
+            CompositeSubscriber<T,MapResultType>(p), func(f)
         {
         }
 
@@ -29,20 +29,25 @@ class OperatorMap : public Operator<T, typename std::result_of<Mapper(const T&)>
 public:
     OperatorMap(){}
 
-    OperatorMap(const MapFunctionType& f) : Operator<T, MapResultType>(),
+    OperatorMap(const MapFunctionType& f) : FusableOperator<T, MapResultType>(),
         func(f)
     {}
 
-    OperatorMap(MapFunctionType&& f) : Operator<T, MapResultType>(),
+    OperatorMap(MapFunctionType&& f) : FusableOperator<T, MapResultType>(),
         func(std::move(f))
     {}
 
     SourceSubscriberType operator()(const ThisSubscriberType& t) override
     {
-        auto subs = std::make_shared<MapSubscriber>(t, std::move(func));
+        auto subs = std::make_shared<MapSubscriber>(t, func);
         subs->addChildSubscriptionFromThis();
         return subs;
     }
+
+    bool applySync(const T& t, const std::function<bool(const MapResultType&)>& consumer) override
+    {
+        return consumer(func(t));
+    }
 private:
     MapFunctionType func;
 };
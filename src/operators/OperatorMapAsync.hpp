@@ -0,0 +1,205 @@
+#ifndef OPERATORMAPASYNC_HPP
+#define OPERATORMAPASYNC_HPP
+#include "Operator.hpp"
+#include "../Scheduler.hpp"
+#include "../utils/MPSCQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+
+//Runs the mapper for every value as a task on the scheduler, at most maxInFlight
+//at a time, and emits the results in the order of the values. Results land in a
+//ring of maxInFlight slots; values beyond the bound wait in a queue. A single
+//thread at a time (the one holding the work-in-progress counter) emits ready
+//slots and starts waiting values. The mapper is called concurrently.
+template<typename T, typename Mapper>
+class OperatorMapAsync : public Operator<T, typename std::result_of<Mapper(const T&)>::type>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using MapResultType        = typename std::result_of<Mapper(const T&)>::type;
+    using ThisSubscriberType   = typename CompositeSubscriber<T,MapResultType>::ChildSubscriberType;
+    using MapFunctionType      = typename std::decay<Mapper>::type;
+
+    struct Slot
+    {
+        Slot() : ready(false)
+        {}
+
+        std::atomic<bool> ready;
+        MapResultType value;
+        std::exception_ptr ex;
+    };
+
+    struct MapAsyncSubscriber : public CompositeSubscriber<T,MapResultType>
+    {
+        MapAsyncSubscriber(ThisSubscriberType p, const MapFunctionType& f,
+                           const Scheduler::SchedulerRefType& scheduler, size_t maxInFlight) :
+            CompositeSubscriber<T,MapResultType>(p), func(f), worker(scheduler->createWorker()),
+            capacity(maxInFlight), slots(new Slot[maxInFlight]), head(0), tail(0), wip(0),
+            parentComplete(false), errorClaimed(false), errorReady(false), done(false)
+        {}
+
+        void onNext(const T& t) override
+        {
+            if(this->isUnsubscribe())
+            {
+                return;
+            }
+            sources.push(t);
+            signal();
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            if(!errorClaimed.exchange(true))
+            {
+                error = ex;
+                errorReady.store(true);
+            }
+            signal();
+        }
+
+        void onComplete() override
+        {
+            parentComplete.store(true);
+            signal();
+        }
+
+        void signal()
+        {
+            if(wip.fetch_add(1) != 0)
+            {
+                return;
+            }
+            int missed = 1;
+            while(true)
+            {
+                drainOnce();
+                missed = wip.fetch_sub(missed) - missed;
+                if(missed == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        //Runs on the thread holding wip only.
+        void drainOnce()
+        {
+            if(done)
+            {
+                return;
+            }
+
+            if(this->isUnsubscribe())
+            {
+                done = true;
+                return;
+            }
+
+            if(errorReady.load())
+            {
+                done = true;
+                this->child->onError(error);
+                this->unsubscribe();
+                return;
+            }
+
+            while(head != tail && slots[head % capacity].ready.load(std::memory_order_acquire))
+            {
+                Slot& slot = slots[head % capacity];
+                MapResultType value = std::move(slot.value);
+                std::exception_ptr ex = slot.ex;
+                slot.ex = nullptr;
+                slot.ready.store(false, std::memory_order_relaxed);
+                ++head;
+
+                if(ex)
+                {
+                    done = true;
+                    this->child->onError(ex);
+                    this->unsubscribe();
+                    return;
+                }
+                this->child->onNext(value);
+            }
+
+            bool sourceDone = parentComplete.load();
+            T t;
+            while(tail - head < capacity && sources.tryPop(t))
+            {
+                launch(t);
+            }
+
+            if(sourceDone && head == tail && sources.empty())
+            {
+                done = true;
+                this->child->onComplete();
+            }
+        }
+
+        void launch(const T& t)
+        {
+            size_t index = tail++ % capacity;
+            auto self = std::static_pointer_cast<MapAsyncSubscriber>(this->shared_from_this());
+            worker->schedule(std::make_shared<Action0>([self, index, t](){
+                self->run(index, t);
+            }));
+        }
+
+        void run(size_t index, const T& t)
+        {
+            Slot& slot = slots[index];
+            if(!this->isUnsubscribe())
+            {
+                try
+                {
+                    slot.value = func(t);
+                }
+                catch(...)
+                {
+                    slot.ex = std::current_exception();
+                }
+            }
+            slot.ready.store(true, std::memory_order_release);
+            signal();
+        }
+
+        MapFunctionType func;
+        Scheduler::WorkerRefType worker;
+        const size_t capacity;
+        std::unique_ptr<Slot[]> slots;
+        //Owned by the thread holding wip.
+        size_t head;
+        size_t tail;
+        std::atomic<int> wip;
+        std::atomic<bool> parentComplete;
+        std::atomic<bool> errorClaimed;
+        std::atomic<bool> errorReady;
+        std::exception_ptr error;
+        MPSCQueue<T> sources;
+        bool done;
+    };
+
+public:
+    OperatorMapAsync(const MapFunctionType& f, const Scheduler::SchedulerRefType& scheduler, size_t maxInFlight) :
+        Operator<T, MapResultType>(), func(f), scheduler(scheduler), maxInFlight(std::max<size_t>(maxInFlight, 1))
+    {}
+
+    OperatorMapAsync(MapFunctionType&& f, const Scheduler::SchedulerRefType& scheduler, size_t maxInFlight) :
+        Operator<T, MapResultType>(), func(std::move(f)), scheduler(scheduler), maxInFlight(std::max<size_t>(maxInFlight, 1))
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<MapAsyncSubscriber>(t, func, scheduler, maxInFlight);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    MapFunctionType func;
+    Scheduler::SchedulerRefType scheduler;
+    size_t maxInFlight;
+};
+
+#endif // OPERATORMAPASYNC_HPP
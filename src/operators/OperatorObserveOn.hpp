@@ -17,8 +17,9 @@ class OperatorObserveOn : public Operator<T,T>
         struct State
         {
             State(SubscriptionBase* subscription) :
-                finished(false), currentValuesCount(0), ex(nullptr), subscription(subscription)
+                wip(0), finished(false), currentValuesCount(0), ex(nullptr), subscription(subscription)
             {}
+            std::atomic_int wip;
             std::atomic_bool finished;
             std::atomic_size_t currentValuesCount;
             std::exception_ptr ex;
@@ -35,27 +36,37 @@ class OperatorObserveOn : public Operator<T,T>
                 : child(c), state(st)
             {}
 
+            //Drains the queue, then leaves unless more drain requests came meanwhile.
+            //Only one drain runs at a time, it holds the state's wip counter.
             void operator()() override
             {
+                int missed = 1;
                 while(true)
                 {
-                    bool done = state->finished.load();
-                    bool empty = state->queue.empty();
-                    size_t valuesCount = state->currentValuesCount.load();
+                    while(true)
+                    {
+                        bool done = state->finished.load();
+                        bool empty = state->queue.empty();
+                        size_t valuesCount = state->currentValuesCount.load();
 
-                    bool terminate = checkTerminateState(done, empty, valuesCount, state->locker);
+                        if(checkTerminateState(done, empty, valuesCount, state->locker))
+                        {
+                            return;
+                        }
+                        T v;
+                        if(!state->queue.tryPop(v))
+                        {
+                            break;
+                        }
+                        child->onNext(v);
+                        --state->currentValuesCount;
+                    }
 
-                    if(terminate)
+                    missed = state->wip.fetch_sub(missed) - missed;
+                    if(missed == 0)
                     {
                         return;
                     }
-                    T v;
-                    bool res = (state->queue).tryPop(v);
-                    if(res)
-                    {
-                        child->onNext(v);
-                        --state->currentValuesCount;
-                    }
                 }
             }
 
@@ -71,21 +82,17 @@ class OperatorObserveOn : public Operator<T,T>
                 }
                 else if(isDone)
                 {
-                    if(!isEmpty)
+                    std::unique_lock<std::mutex> locker(lock);
+                    if(state->ex)
                     {
-                        std::unique_lock<std::mutex> locker(lock);
-                        if(state->ex)
-                        {
-                            state->queue.clear();
-                            child->onError(state->ex);
-                            state->ex = nullptr;
-                            state->subscription->unsubscribe();
-                            return true;
-                        }
-                        return false;
-                    } else if(valuesCount == 0)
+                        state->queue.clear();
+                        child->onError(state->ex);
+                        state->ex = nullptr;
+                        state->subscription->unsubscribe();
+                        return true;
+                    }
+                    if(isEmpty && valuesCount == 0)
                     {
-                        std::unique_lock<std::mutex> locker(lock);
                         if(!state->subscription->isUnsubscribe())
                         {
                             child->onComplete();
@@ -101,21 +108,36 @@ class OperatorObserveOn : public Operator<T,T>
             StateRefType state;
         };
 
-        ObserveOnSubscriber(ThisSubscriberType p,const Scheduler::SchedulerRefType& s, size_t bufferSize) :
-            CompositeSubscriber<T,T>(p), scheduler(s), bufferSize(bufferSize)
+        ObserveOnSubscriber(ThisSubscriberType p,const Scheduler::SchedulerRefType& s, size_t bufferSize,
+                            Priority priority) :
+            CompositeSubscriber<T,T>(p), scheduler(s), bufferSize(bufferSize), priority(priority)
         {}
 
         void onNext(const T& t) override
         {
             if(!this->isUnsubscribe() && !state->finished.load())
             {
+                //Already on the target worker with nothing queued: no hop needed.
+                //Not under a running trampoline though: it would defer the value
+                //past this onNext, where the counters no longer order it.
+                if(worker->isCurrentThread() && !Trampoline::isActive() &&
+                        state->currentValuesCount.load() == 0 && state->wip.load() == 0)
+                {
+                    Trampoline::run([this, &t](){
+                        this->child->onNext(t);
+                    });
+                    return;
+                }
+
                 if(!state->queue.offer(std::move(t)))
                 {
                     throw SlowSubscriberException();
                 }
                 ++state->currentValuesCount;
-                auto ssubscription = worker->schedule(std::make_shared<ThreadAction>(this->child, state));
-                this->add(ssubscription);
+                if(state->wip.fetch_add(1) == 0)
+                {
+                    worker->schedule(std::make_shared<ThreadAction>(this->child, state), priority);
+                }
             }
         }
 
@@ -124,6 +146,7 @@ class OperatorObserveOn : public Operator<T,T>
             if(!state->finished.load())
             {
                 state->finished.store(true);
+                scheduleTermination();
             }
         }
 
@@ -135,8 +158,21 @@ class OperatorObserveOn : public Operator<T,T>
             }
 
             state->finished.store(true);
-            std::unique_lock<std::mutex> guard(state->locker);
-            state->ex = ex;
+            {
+                std::unique_lock<std::mutex> guard(state->locker);
+                state->ex = ex;
+            }
+            scheduleTermination();
+        }
+
+        //Terminal events need a drain pass of their own: values emitted inline
+        //never scheduled one.
+        void scheduleTermination()
+        {
+            if(state->wip.fetch_add(1) == 0)
+            {
+                worker->scheduleOrRun(std::make_shared<ThreadAction>(this->child, state), priority);
+            }
         }
 
         void init()
@@ -151,22 +187,25 @@ class OperatorObserveOn : public Operator<T,T>
         Scheduler::WorkerRefType worker;
         StateRefType state;
         size_t bufferSize;
+        Priority priority;
     };
 
 public:
-    OperatorObserveOn(const Scheduler::SchedulerRefType& scheduler,size_t bufferSize) :
-        scheduler(scheduler), bufferSize(bufferSize)
+    OperatorObserveOn(const Scheduler::SchedulerRefType& scheduler,size_t bufferSize,
+                      Priority priority = Priority::Normal) :
+        scheduler(scheduler), bufferSize(bufferSize), priority(priority)
     {}
 
     SourceSubscriberType operator()(const ThisSubscriberType& t) override
     {
-        auto subs = std::make_shared<ObserveOnSubscriber>(t, scheduler, bufferSize);
+        auto subs = std::make_shared<ObserveOnSubscriber>(t, scheduler, bufferSize, priority);
         subs->init();
         return subs;
     }
 private:
     Scheduler::SchedulerRefType scheduler;
     size_t bufferSize;
+    Priority priority;
 };
 
 #endif // OPERATOROBSERVEON_H
@@ -0,0 +1,213 @@
+#ifndef OPERATOROBSERVEONBATCHED_HPP
+#define OPERATOROBSERVEONBATCHED_HPP
+#include "OperatorObserveOn.hpp"
+#include "../utils/MPSCQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+//observeOn that hands values over in batches: the producer side collects up to
+//batchSize values and publishes them as one entry of OperatorObserveOn's queue,
+//when the batch is full or once linger has passed since its first value. The
+//consumer side unpacks the batch on the target worker. Batches are cut under a
+//lock but handed over outside of it, in order, by whichever thread holds the
+//work-in-progress counter.
+template<typename T>
+class OperatorObserveOnBatched : public Operator<T,T>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T,T>::ChildSubscriberType;
+    using BatchType            = std::vector<T>;
+    using BatchSubscriberType  = std::shared_ptr<Subscriber<BatchType>>;
+
+    struct UnbatchSubscriber : public CompositeSubscriber<BatchType,T>
+    {
+        UnbatchSubscriber(ThisSubscriberType p) : CompositeSubscriber<BatchType,T>(p)
+        {}
+
+        void onNext(const BatchType& batch) override
+        {
+            for(auto& t : batch)
+            {
+                if(this->child->isUnsubscribe())
+                {
+                    return;
+                }
+                this->child->onNext(t);
+            }
+        }
+    };
+
+    struct BatchSubscriber : public CompositeSubscriber<T,BatchType>
+    {
+        BatchSubscriber(BatchSubscriberType p, const Scheduler::SchedulerRefType& scheduler,
+                        size_t batchSize, std::chrono::steady_clock::duration linger) :
+            CompositeSubscriber<T,BatchType>(p), worker(scheduler->createWorker()),
+            batchSize(batchSize), linger(linger), generation(0), wip(0), terminated(false), finished(false)
+        {
+            batch.reserve(batchSize);
+        }
+
+        void onNext(const T& t) override
+        {
+            {
+                std::lock_guard<std::mutex> l(lock);
+                batch.push_back(t);
+                if(batch.size() < batchSize)
+                {
+                    if(batch.size() == 1)
+                    {
+                        armLinger();
+                    }
+                    return;
+                }
+                flush();
+            }
+            drain();
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            {
+                std::lock_guard<std::mutex> l(lock);
+                flush();
+                error = ex;
+                terminated.store(true);
+            }
+            drain();
+        }
+
+        void onComplete() override
+        {
+            {
+                std::lock_guard<std::mutex> l(lock);
+                flush();
+                terminated.store(true);
+            }
+            drain();
+        }
+
+        //The timer only holds a weak reference and is cancelled as soon as its
+        //batch leaves, so full batches leave nothing behind on the shared timer.
+        void armLinger()
+        {
+            std::weak_ptr<BatchSubscriber> weak =
+                    std::static_pointer_cast<BatchSubscriber>(this->shared_from_this());
+            size_t gen = generation;
+            lingerTimer = worker->scheduleDelayed(std::make_shared<Action0>([weak, gen](){
+                auto self = weak.lock();
+                if(!self)
+                {
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> l(self->lock);
+                    if(self->generation != gen)
+                    {
+                        return;
+                    }
+                    self->flush();
+                }
+                self->drain();
+            }), linger);
+        }
+
+        //Called under the lock: cuts the batch and queues it for drain().
+        void flush()
+        {
+            if(batch.empty())
+            {
+                return;
+            }
+            ++generation;
+            if(lingerTimer != nullptr)
+            {
+                lingerTimer->unsubscribe();
+                lingerTimer = nullptr;
+            }
+            BatchType out;
+            out.reserve(batchSize);
+            out.swap(batch);
+            ready.push(std::move(out));
+        }
+
+        void drain()
+        {
+            if(wip.fetch_add(1) != 0)
+            {
+                return;
+            }
+            int missed = 1;
+            while(true)
+            {
+                //Read first: a terminal event is set after its last batch was queued.
+                bool term = terminated.load();
+                BatchType out;
+                while(!finished && ready.tryPop(out))
+                {
+                    this->child->onNext(out);
+                }
+                if(term && !finished)
+                {
+                    finished = true;
+                    if(error)
+                    {
+                        this->child->onError(error);
+                    }
+                    else
+                    {
+                        this->child->onComplete();
+                    }
+                }
+                missed = wip.fetch_sub(missed) - missed;
+                if(missed == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        Scheduler::WorkerRefType worker;
+        const size_t batchSize;
+        const std::chrono::steady_clock::duration linger;
+        std::mutex lock;
+        BatchType batch;
+        size_t generation;
+        SubscriptionPtrType lingerTimer;
+        MPSCQueue<BatchType> ready;
+        std::atomic<int> wip;
+        std::atomic<bool> terminated;
+        std::exception_ptr error;
+        //Owned by the thread holding wip.
+        bool finished;
+    };
+
+public:
+    template<typename Rep, typename Period>
+    OperatorObserveOnBatched(const Scheduler::SchedulerRefType& scheduler, size_t batchSize,
+                             const std::chrono::duration<Rep, Period>& linger,
+                             Priority priority = Priority::Normal) :
+        scheduler(scheduler), batchSize(std::max<size_t>(batchSize, 1)),
+        linger(std::chrono::duration_cast<std::chrono::steady_clock::duration>(linger)), priority(priority)
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto unbatch = std::make_shared<UnbatchSubscriber>(t);
+        unbatch->addChildSubscriptionFromThis();
+        OperatorObserveOn<BatchType> observeOn(scheduler, std::numeric_limits<size_t>::max(), priority);
+        auto handoff = observeOn(unbatch);
+        auto subs = std::make_shared<BatchSubscriber>(handoff, scheduler, batchSize, linger);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    Scheduler::SchedulerRefType scheduler;
+    size_t batchSize;
+    std::chrono::steady_clock::duration linger;
+    Priority priority;
+};
+
+#endif // OPERATOROBSERVEONBATCHED_HPP
@@ -0,0 +1,114 @@
+#ifndef OPERATOROBSERVEONPARTITIONED_HPP
+#define OPERATOROBSERVEONPARTITIONED_HPP
+#include "Operator.hpp"
+#include "../schedulers/PartitionedScheduler.hpp"
+#include <atomic>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+//observeOn that routes every value to the partition of its key: values sharing
+//a key are delivered serially and in order on one thread, different keys in
+//parallel. The child has to accept concurrent onNext calls for different keys.
+template<typename T, typename KeySelector>
+class OperatorObserveOnPartitioned : public Operator<T,T>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T,T>::ChildSubscriberType;
+    using KeySelectorType      = typename std::decay<KeySelector>::type;
+    using KeyType              = typename std::decay<typename std::result_of<KeySelectorType(const T&)>::type>::type;
+    using SchedulerType        = std::shared_ptr<PartitionedScheduler>;
+
+    struct PartitionedSubscriber : public CompositeSubscriber<T,T>
+    {
+        PartitionedSubscriber(ThisSubscriberType p, const SchedulerType& scheduler, const KeySelectorType& kSelector) :
+            CompositeSubscriber<T,T>(p), keySelector(kSelector), remaining(0), terminated(false)
+        {
+            for(size_t i = 0; i < scheduler->partitions(); ++i)
+            {
+                lanes.push_back(scheduler->createWorkerForKey(i));
+            }
+        }
+
+        void onNext(const T& t) override
+        {
+            if(this->isUnsubscribe() || terminated.load())
+            {
+                return;
+            }
+            auto& lane = lanes[hasher(keySelector(t)) % lanes.size()];
+            auto self = std::static_pointer_cast<PartitionedSubscriber>(this->shared_from_this());
+            lane->schedule(std::make_shared<Action0>([self, t](){
+                if(!self->isUnsubscribe())
+                {
+                    self->child->onNext(t);
+                }
+            }));
+        }
+
+        void onComplete() override
+        {
+            terminate(nullptr);
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            terminate(ex);
+        }
+
+        //The terminal event travels through every lane behind the values already
+        //queued there; the last lane to reach it notifies the child.
+        void terminate(std::exception_ptr ex)
+        {
+            if(terminated.exchange(true))
+            {
+                return;
+            }
+            remaining.store(lanes.size());
+            auto self = std::static_pointer_cast<PartitionedSubscriber>(this->shared_from_this());
+            for(auto& lane : lanes)
+            {
+                lane->schedule(std::make_shared<Action0>([self, ex](){
+                    if(--self->remaining == 0 && !self->isUnsubscribe())
+                    {
+                        if(ex)
+                        {
+                            self->child->onError(ex);
+                        }
+                        else
+                        {
+                            self->child->onComplete();
+                        }
+                    }
+                }));
+            }
+        }
+
+        KeySelectorType keySelector;
+        std::hash<KeyType> hasher;
+        std::vector<Scheduler::WorkerRefType> lanes;
+        std::atomic<size_t> remaining;
+        std::atomic<bool> terminated;
+    };
+
+public:
+    OperatorObserveOnPartitioned(const SchedulerType& scheduler, const KeySelectorType& kSelector) :
+        scheduler(scheduler), keySelector(kSelector)
+    {}
+
+    OperatorObserveOnPartitioned(const SchedulerType& scheduler, KeySelectorType&& kSelector) :
+        scheduler(scheduler), keySelector(std::move(kSelector))
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<PartitionedSubscriber>(t, scheduler, keySelector);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    SchedulerType scheduler;
+    KeySelectorType keySelector;
+};
+
+#endif // OPERATOROBSERVEONPARTITIONED_HPP
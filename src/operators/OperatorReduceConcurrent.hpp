@@ -0,0 +1,86 @@
+#ifndef OPERATORREDUCECONCURRENT_HPP
+#define OPERATORREDUCECONCURRENT_HPP
+#include "Operator.hpp"
+#include "../utils/ThreadLocalPartials.hpp"
+#include <atomic>
+#include <type_traits>
+
+//reduce for sources emitting from several threads at once. Every thread folds
+//into a partial of its own, the partials are folded together on completion, so
+//the accumulator has to be associative and commutative. Emits nothing for an
+//empty source.
+template<typename T, typename Accumulator>
+class OperatorReduceConcurrent : public Operator<T, T>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T,T>::ChildSubscriberType;
+    using AccumulatorType      = typename std::decay<Accumulator>::type;
+
+    struct Partial
+    {
+        bool hasValue = false;
+        T value;
+    };
+
+    struct ReduceConcurrentSubscriber : public CompositeSubscriber<T,T>
+    {
+        ReduceConcurrentSubscriber(ThisSubscriberType p, const AccumulatorType& accumulator) :
+            CompositeSubscriber<T,T>(p), accumulator(accumulator), terminated(false)
+        {}
+
+        void onNext(const T& t) override
+        {
+            Partial& partial = partials.local();
+            partial.value = partial.hasValue ? accumulator(partial.value, t) : t;
+            partial.hasValue = true;
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            if(!terminated.exchange(true))
+            {
+                this->child->onError(ex);
+            }
+        }
+
+        void onComplete() override
+        {
+            if(terminated.exchange(true))
+            {
+                return;
+            }
+            Partial result;
+            partials.forEach([&](Partial& partial){
+                if(partial.hasValue)
+                {
+                    result.value = result.hasValue ? accumulator(result.value, partial.value) : partial.value;
+                    result.hasValue = true;
+                }
+            });
+            if(result.hasValue)
+            {
+                this->child->onNext(result.value);
+            }
+            this->child->onComplete();
+        }
+
+        AccumulatorType accumulator;
+        ThreadLocalPartials<Partial> partials;
+        std::atomic<bool> terminated;
+    };
+
+public:
+    OperatorReduceConcurrent(const AccumulatorType& accumulator) : Operator<T, T>(), accumulator(accumulator)
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<ReduceConcurrentSubscriber>(t, accumulator);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    AccumulatorType accumulator;
+};
+
+#endif // OPERATORREDUCECONCURRENT_HPP
@@ -0,0 +1,109 @@
+#ifndef OPERATORSAMPLE_HPP
+#define OPERATORSAMPLE_HPP
+#include "Operator.hpp"
+#include "../Scheduler.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+//Emits the latest value once every period, if a new one arrived since the
+//previous tick. One periodic action on the shared timer drives the ticks; they
+//skip the lock while no value is pending.
+template<typename T>
+class OperatorSample : public Operator<T,T>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T,T>::ChildSubscriberType;
+
+    struct SampleSubscriber : public CompositeSubscriber<T,T>
+    {
+        SampleSubscriber(ThisSubscriberType p, const Scheduler::SchedulerRefType& scheduler) :
+            CompositeSubscriber<T,T>(p), worker(scheduler->createWorker()), hasValue(false), done(false)
+        {}
+
+        void start(std::chrono::steady_clock::duration period)
+        {
+            //Weak reference, the periodic action lives as long as its subscription.
+            std::weak_ptr<SampleSubscriber> weak =
+                    std::static_pointer_cast<SampleSubscriber>(this->shared_from_this());
+            ticks = worker->schedulePeriodically(std::make_shared<Action0>([weak](){
+                if(auto self = weak.lock())
+                {
+                    self->tick();
+                }
+            }), period, period);
+            this->add(ticks);
+        }
+
+        void onNext(const T& t) override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            latest = t;
+            hasValue.store(true, std::memory_order_release);
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            finish();
+            this->child->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            finish();
+            this->child->onComplete();
+        }
+
+        void tick()
+        {
+            if(!hasValue.load(std::memory_order_acquire))
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> l(lock);
+            if(done || !hasValue.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+            hasValue.store(false, std::memory_order_relaxed);
+            this->child->onNext(latest);
+        }
+
+        //Called under the lock.
+        void finish()
+        {
+            done = true;
+            hasValue.store(false);
+            ticks->unsubscribe();
+        }
+
+        Scheduler::WorkerRefType worker;
+        SubscriptionPtrType ticks;
+        std::mutex lock;
+        T latest;
+        std::atomic<bool> hasValue;
+        bool done;
+    };
+
+public:
+    template<typename Rep, typename Period>
+    OperatorSample(const std::chrono::duration<Rep, Period>& period,
+                   const Scheduler::SchedulerRefType& scheduler) :
+        scheduler(scheduler), period(std::chrono::duration_cast<std::chrono::steady_clock::duration>(period))
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<SampleSubscriber>(t, scheduler);
+        subs->addChildSubscriptionFromThis();
+        subs->start(period);
+        return subs;
+    }
+private:
+    Scheduler::SchedulerRefType scheduler;
+    std::chrono::steady_clock::duration period;
+};
+
+#endif // OPERATORSAMPLE_HPP
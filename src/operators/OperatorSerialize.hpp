@@ -0,0 +1,144 @@
+#ifndef OPERATORSERIALIZE_HPP
+#define OPERATORSERIALIZE_HPP
+
+#include "Operator.hpp"
+#include "../utils/MPSCQueue.hpp"
+#include <atomic>
+
+//Serializes onNext/onError/onComplete coming from any number of threads without
+//a lock: the thread that takes the work-in-progress counter from zero emits, the
+//others queue their event and return at once, and the emitting thread drains
+//their events before it leaves. Events after the first terminal one are dropped.
+template<typename T>
+class SerializedSubscriber : public CompositeSubscriber<T,T>
+{
+public:
+    using ThisSubscriberType = typename CompositeSubscriber<T,T>::ChildSubscriberType;
+
+    SerializedSubscriber(ThisSubscriberType p) :
+        CompositeSubscriber<T,T>(p), wip(0), done(false)
+    {}
+
+    void onNext(const T& t) override
+    {
+        int expected = 0;
+        if(wip.compare_exchange_strong(expected, 1))
+        {
+            if(!done)
+            {
+                this->child->onNext(t);
+            }
+            int missed = wip.fetch_sub(1) - 1;
+            if(missed != 0)
+            {
+                drain(missed);
+            }
+            return;
+        }
+        emit(Event(t));
+    }
+
+    void onError(std::exception_ptr ex) override
+    {
+        emit(Event(ex));
+    }
+
+    void onComplete() override
+    {
+        emit(Event());
+    }
+
+private:
+    struct Event
+    {
+        enum Kind
+        {
+            ON_NEXT,
+            ON_ERROR,
+            ON_COMPLETE
+        };
+
+        Event() : kind(ON_COMPLETE)
+        {}
+
+        explicit Event(const T& t) : kind(ON_NEXT), value(t)
+        {}
+
+        explicit Event(std::exception_ptr ex) : kind(ON_ERROR), ex(ex)
+        {}
+
+        Kind kind;
+        T value;
+        std::exception_ptr ex;
+    };
+
+    void emit(Event&& event)
+    {
+        queue.push(std::move(event));
+        if(wip.fetch_add(1) == 0)
+        {
+            drain(1);
+        }
+    }
+
+    void drain(int missed)
+    {
+        while(true)
+        {
+            Event event;
+            while(queue.tryPop(event))
+            {
+                deliver(event);
+            }
+            missed = wip.fetch_sub(missed) - missed;
+            if(missed == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    void deliver(const Event& event)
+    {
+        if(done)
+        {
+            return;
+        }
+        switch(event.kind)
+        {
+        case Event::ON_NEXT:
+            this->child->onNext(event.value);
+            break;
+        case Event::ON_ERROR:
+            done = true;
+            this->child->onError(event.ex);
+            break;
+        case Event::ON_COMPLETE:
+            done = true;
+            this->child->onComplete();
+            break;
+        }
+    }
+
+    MPSCQueue<Event> queue;
+    std::atomic<int> wip;
+    //Only touched by the thread holding wip.
+    bool done;
+};
+
+template<typename T>
+class OperatorSerialize : public Operator<T,T>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T,T>::ChildSubscriberType;
+
+public:
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<SerializedSubscriber<T>>(t);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+};
+
+#endif // OPERATORSERIALIZE_HPP
@@ -0,0 +1,234 @@
+#ifndef OPERATORSTAGE_HPP
+#define OPERATORSTAGE_HPP
+#include "Operator.hpp"
+#include "../Scheduler.hpp"
+#include "../utils/SPSCQueue.hpp"
+#include "../utils/ThreadPoolExecutor.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+//Counters of one stage boundary, updated while the pipeline runs.
+struct StageStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    StageStats() : values(0), occupancy(0), maxOccupancy(0), busy(0), blocked(0),
+        started(Clock::now().time_since_epoch().count())
+    {}
+
+    //Share of the time since the stage started that its thread spent on values.
+    double utilization() const
+    {
+        Clock::rep elapsed = Clock::now().time_since_epoch().count() - started.load();
+        return elapsed > 0 ? static_cast<double>(busy.load()) / elapsed : 0.0;
+    }
+
+    std::chrono::nanoseconds busyTime() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::duration(busy.load()));
+    }
+
+    //Time the upstream stage waited on a full queue.
+    std::chrono::nanoseconds blockedTime() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::duration(blocked.load()));
+    }
+
+    std::atomic<size_t> values;
+    std::atomic<size_t> occupancy;
+    std::atomic<size_t> maxOccupancy;
+    std::atomic<Clock::rep> busy;
+    std::atomic<Clock::rep> blocked;
+    std::atomic<Clock::rep> started;
+};
+
+using StageStatsPtrType = std::shared_ptr<StageStats>;
+
+//Stage boundary: the rest of the chain runs on the scheduler's worker, fed
+//through a bounded single-producer single-consumer queue, holding exactly
+//capacity values although the ring itself is rounded up to a power of two.
+//A full queue blocks
+//the upstream stage (as a managed blocking call when it runs on a pool), which
+//is the backpressure between stages. The upstream must not run on the stage's
+//own worker.
+template<typename T>
+class OperatorStage : public Operator<T,T>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T,T>::ChildSubscriberType;
+    using Clock                = StageStats::Clock;
+
+    struct StageSubscriber : public CompositeSubscriber<T,T>
+    {
+        StageSubscriber(ThisSubscriberType p, const Scheduler::SchedulerRefType& scheduler,
+                        size_t capacity, const StageStatsPtrType& stats) :
+            CompositeSubscriber<T,T>(p), worker(scheduler->createWorker()),
+            capacity(std::max<size_t>(capacity, 1)), queue(this->capacity), stats(stats), wip(0), producerWaiting(false), terminated(false), delivered(false)
+        {
+            if(stats)
+            {
+                stats->started.store(Clock::now().time_since_epoch().count());
+            }
+        }
+
+        void onNext(const T& t) override
+        {
+            if(this->isUnsubscribe())
+            {
+                return;
+            }
+            if(!tryPush(t))
+            {
+                waitForSpace(t);
+            }
+            if(stats)
+            {
+                size_t occupancy = queue.size();
+                stats->occupancy.store(occupancy);
+                size_t prev = stats->maxOccupancy.load();
+                while(occupancy > prev && !stats->maxOccupancy.compare_exchange_weak(prev, occupancy))
+                {}
+            }
+            signal();
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            error = ex;
+            terminated.store(true);
+            signal();
+        }
+
+        void onComplete() override
+        {
+            terminated.store(true);
+            signal();
+        }
+
+        //Producer side: tail is its own, so size() never reads below the real occupancy.
+        bool tryPush(const T& t)
+        {
+            return queue.size() < capacity && queue.tryPush(t);
+        }
+
+        void waitForSpace(const T& t)
+        {
+            ManagedBlocker blocker;
+            auto start = Clock::now();
+            std::unique_lock<std::mutex> l(lock);
+            producerWaiting.store(true);
+            while(!tryPush(t))
+            {
+                if(this->isUnsubscribe())
+                {
+                    break;
+                }
+                //Bounded wait: a wakeup racing with the flag costs at most a millisecond.
+                notFull.wait_for(l, std::chrono::milliseconds(1));
+            }
+            producerWaiting.store(false);
+            if(stats)
+            {
+                stats->blocked += (Clock::now() - start).count();
+            }
+        }
+
+        void signal()
+        {
+            if(wip.fetch_add(1) == 0)
+            {
+                auto self = std::static_pointer_cast<StageSubscriber>(this->shared_from_this());
+                worker->schedule(std::make_shared<Action0>([self](){
+                    self->drain();
+                }));
+            }
+        }
+
+        void drain()
+        {
+            int missed = 1;
+            while(true)
+            {
+                T v;
+                while(!this->child->isUnsubscribe() && queue.tryPop(v))
+                {
+                    wakeProducer();
+                    if(stats)
+                    {
+                        auto start = Clock::now();
+                        this->child->onNext(v);
+                        stats->busy += (Clock::now() - start).count();
+                        ++stats->values;
+                        stats->occupancy.store(queue.size());
+                    }
+                    else
+                    {
+                        this->child->onNext(v);
+                    }
+                }
+
+                if(terminated.load() && queue.empty() && !delivered)
+                {
+                    delivered = true;
+                    if(error)
+                    {
+                        this->child->onError(error);
+                    }
+                    else
+                    {
+                        this->child->onComplete();
+                    }
+                }
+
+                missed = wip.fetch_sub(missed) - missed;
+                if(missed == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        void wakeProducer()
+        {
+            if(producerWaiting.load())
+            {
+                std::lock_guard<std::mutex> l(lock);
+                notFull.notify_one();
+            }
+        }
+
+        Scheduler::WorkerRefType worker;
+        const size_t capacity;
+        SPSCQueue<T> queue;
+        StageStatsPtrType stats;
+        std::atomic<int> wip;
+        std::mutex lock;
+        std::condition_variable notFull;
+        std::atomic<bool> producerWaiting;
+        std::atomic<bool> terminated;
+        std::exception_ptr error;
+        //Only touched by the draining thread.
+        bool delivered;
+    };
+
+public:
+    OperatorStage(const Scheduler::SchedulerRefType& scheduler, size_t capacity, const StageStatsPtrType& stats) :
+        scheduler(scheduler), capacity(capacity), stats(stats)
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<StageSubscriber>(t, scheduler, capacity, stats);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    Scheduler::SchedulerRefType scheduler;
+    size_t capacity;
+    StageStatsPtrType stats;
+};
+
+#endif // OPERATORSTAGE_HPP
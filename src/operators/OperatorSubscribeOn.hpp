@@ -31,12 +31,14 @@ public:
     void operator()(const SubscriberPtrType<T>& subscriber) override
     {
         worker = std::move(scheduler->createWorker());
-        auto subscription = worker->schedule(std::unique_ptr<Action0>(make_unique<ThreadAction>(source, subscriber)));
+        auto subscription = worker->scheduleOrRun(std::unique_ptr<Action0>(make_unique<ThreadAction>(source, subscriber)));
         subscriber->add(subscription);
     }
 private:
     OnSubscribePtrType source;
     Scheduler::SchedulerRefType scheduler;
+    //Its executor drops queued tasks on destruction, so operators that subscribe
+    //to sources asynchronously hold on to the sources until they terminate.
     Scheduler::WorkerRefType worker;
 };
 
@@ -28,6 +28,12 @@ class OperatorSynchronize : public Operator<T,T>
             this->child->onComplete();
         }
 
+        void onError(std::exception_ptr ex) override
+        {
+            std::lock_guard<L> ul(lock);
+            this->child->onError(ex);
+        }
+
         L lock;
     };
 
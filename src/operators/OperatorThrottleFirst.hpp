@@ -0,0 +1,63 @@
+#ifndef OPERATORTHROTTLEFIRST_HPP
+#define OPERATORTHROTTLEFIRST_HPP
+#include "Operator.hpp"
+#include "../Scheduler.hpp"
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+//Emits a value and drops the following ones until window has passed on the
+//worker's clock. No timer is needed, the gate is a single atomic time.
+template<typename T>
+class OperatorThrottleFirst : public Operator<T,T>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T,T>::ChildSubscriberType;
+    using TicksType            = std::chrono::steady_clock::rep;
+
+    struct ThrottleFirstSubscriber : public CompositeSubscriber<T,T>
+    {
+        ThrottleFirstSubscriber(ThisSubscriberType p, const Scheduler::SchedulerRefType& scheduler,
+                                std::chrono::steady_clock::duration window) :
+            CompositeSubscriber<T,T>(p), worker(scheduler->createWorker()), window(window.count()),
+            gate(std::numeric_limits<TicksType>::min())
+        {}
+
+        void onNext(const T& t) override
+        {
+            if(this->isUnsubscribe())
+            {
+                return;
+            }
+            TicksType now = worker->now().time_since_epoch().count();
+            TicksType open = gate.load(std::memory_order_relaxed);
+            if(now >= open && gate.compare_exchange_strong(open, now + window))
+            {
+                this->child->onNext(t);
+            }
+        }
+
+        Scheduler::WorkerRefType worker;
+        const TicksType window;
+        std::atomic<TicksType> gate;
+    };
+
+public:
+    template<typename Rep, typename Period>
+    OperatorThrottleFirst(const std::chrono::duration<Rep, Period>& window,
+                          const Scheduler::SchedulerRefType& scheduler) :
+        scheduler(scheduler), window(std::chrono::duration_cast<std::chrono::steady_clock::duration>(window))
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<ThrottleFirstSubscriber>(t, scheduler, window);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    Scheduler::SchedulerRefType scheduler;
+    std::chrono::steady_clock::duration window;
+};
+
+#endif // OPERATORTHROTTLEFIRST_HPP
@@ -1,20 +1,28 @@
 #ifndef OPERATORTOMAP_HPP
 #define OPERATORTOMAP_HPP
 #include "Operator.hpp"
+#include "../utils/MapUtil.hpp"
+#include "../utils/ThreadLocalPartials.hpp"
+#include <atomic>
 #include <type_traits>
 #include <map>
+#include <unordered_map>
 
 template<typename T, typename KeySelector, typename ValueSelector>
 using MapT = std::map<typename std::result_of<KeySelector(const T&)>::type,
                       typename std::result_of<ValueSelector(const T&)>::type>;
 
-template<typename T, typename KeySelector, typename ValueSelector, typename ValuePrevSelector>
-class OperatorToMap : public Operator<T, MapT<T,KeySelector,ValueSelector>>
+template<typename T, typename KeySelector, typename ValueSelector>
+using UnorderedMapT = std::unordered_map<typename std::decay<typename std::result_of<KeySelector(const T&)>::type>::type,
+                                         typename std::decay<typename std::result_of<ValueSelector(const T&)>::type>::type>;
+
+//Collects the source into a map of MapType, std::map unless asked otherwise;
+//expectedSize pre-sizes hash maps.
+template<typename T, typename KeySelector, typename ValueSelector, typename ValuePrevSelector,
+         typename MapType = MapT<T,KeySelector,ValueSelector>>
+class OperatorToMap : public Operator<T, MapType>
 {
-    using KeyType               = typename std::result_of<KeySelector(const T&)>::type;
-    using ValueType             = typename std::result_of<ValueSelector(const T&)>::type;
     using SourceSubscriberType  = std::shared_ptr<Subscriber<T>>;
-    using MapType               = MapT<T,KeySelector,ValueSelector>;
     using ThisSubscriberType    = typename CompositeSubscriber<T, MapType>::ChildSubscriberType;
     using KeySelectorType       = typename std::decay<KeySelector>::type;
     using ValueSelectorType     = typename std::decay<ValueSelector>::type;
@@ -23,22 +31,25 @@ class OperatorToMap : public Operator<T, MapT<T,KeySelector,ValueSelector>>
     struct ToMapSubscriber : public CompositeSubscriber<T, MapType>
     {
         ToMapSubscriber(ThisSubscriberType p, KeySelectorType&& kSelector, ValueSelectorType&& vSelector
-                        ,ValuePrevSelectorType&& vpSelector) :
+                        ,ValuePrevSelectorType&& vpSelector, size_t expectedSize) :
             CompositeSubscriber<T, MapType>(p), keySelector(std::move(kSelector)),
             valueSelector(std::move(vSelector)), valuePrevSelector(std::move(vpSelector))
-        {}
+        {
+            mapReserve(map, expectedSize);
+        }
 
         void onNext(const T& t) override
         {
-            auto key = (*keySelector)(t);
-            auto value = (*valueSelector)(t);
-            auto prev = (map.find(key) == map.end() ? value : map[key]);
-            map[key] = (*valuePrevSelector)(value, prev);
+            auto value = valueSelector(t);
+            mapUpsert(map, keySelector(t), value, valuePrevSelector);
         }
 
+        //The map is handed out by reference and released right after, so the
+        //operator never holds a second copy of it.
         void onComplete() override
         {
             this->child->onNext(map);
+            MapType().swap(map);
             this->child->onComplete();
         }
 
@@ -50,14 +61,111 @@ class OperatorToMap : public Operator<T, MapT<T,KeySelector,ValueSelector>>
 
 public:
     OperatorToMap(){}
-    OperatorToMap(KeySelectorType kSelector, ValueSelectorType vSelector, ValuePrevSelectorType vpSelector) : Operator<T, MapType>(),
-        keySelector(std::move(kSelector)), valueSelector(std::move(vSelector)), valuePrevSelector(std::move(vpSelector))
+    OperatorToMap(KeySelectorType kSelector, ValueSelectorType vSelector, ValuePrevSelectorType vpSelector,
+                  size_t expectedSize = 0) : Operator<T, MapType>(),
+        keySelector(std::move(kSelector)), valueSelector(std::move(vSelector)), valuePrevSelector(std::move(vpSelector)),
+        expectedSize(expectedSize)
     {}
 
     SourceSubscriberType operator()(const ThisSubscriberType& t) override
     {
         auto subs = std::make_shared<ToMapSubscriber>(t, std::move(keySelector),
-                         std::move(valueSelector), std::move(valuePrevSelector));
+                         std::move(valueSelector), std::move(valuePrevSelector), expectedSize);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    KeySelectorType keySelector;
+    ValueSelectorType valueSelector;
+    ValuePrevSelectorType valuePrevSelector;
+    size_t expectedSize = 0;
+};
+
+//toMap for sources emitting from several threads at once, without an upstream
+//synchronize(). Every thread accumulates into a hash map of its own; on
+//completion the partial maps are merged, values of a key found in several of
+//them folded with the combiner.
+template<typename T, typename KeySelector, typename ValueSelector, typename ValuePrevSelector, typename Combiner>
+class OperatorToMapConcurrent : public Operator<T, MapT<T,KeySelector,ValueSelector>>
+{
+    using KeyType               = typename std::decay<typename std::result_of<KeySelector(const T&)>::type>::type;
+    using ValueType             = typename std::decay<typename std::result_of<ValueSelector(const T&)>::type>::type;
+    using SourceSubscriberType  = std::shared_ptr<Subscriber<T>>;
+    using MapType               = MapT<T,KeySelector,ValueSelector>;
+    using PartialType           = std::unordered_map<KeyType, ValueType>;
+    using ThisSubscriberType    = typename CompositeSubscriber<T, MapType>::ChildSubscriberType;
+    using KeySelectorType       = typename std::decay<KeySelector>::type;
+    using ValueSelectorType     = typename std::decay<ValueSelector>::type;
+    using ValuePrevSelectorType = typename std::decay<ValuePrevSelector>::type;
+    using CombinerType          = typename std::decay<Combiner>::type;
+
+    struct ToMapConcurrentSubscriber : public CompositeSubscriber<T, MapType>
+    {
+        ToMapConcurrentSubscriber(ThisSubscriberType p, const KeySelectorType& kSelector,
+                                  const ValueSelectorType& vSelector, const ValuePrevSelectorType& vpSelector,
+                                  const CombinerType& combiner) :
+            CompositeSubscriber<T, MapType>(p), keySelector(kSelector), valueSelector(vSelector),
+            valuePrevSelector(vpSelector), combiner(combiner), terminated(false)
+        {}
+
+        void onNext(const T& t) override
+        {
+            ValueType value = valueSelector(t);
+            mapUpsert(partials.local(), keySelector(t), value, valuePrevSelector);
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            if(!terminated.exchange(true))
+            {
+                this->child->onError(ex);
+            }
+        }
+
+        void onComplete() override
+        {
+            if(terminated.exchange(true))
+            {
+                return;
+            }
+            MapType map;
+            partials.forEach([&](PartialType& partial){
+                for(auto& entry : partial)
+                {
+                    auto it = map.lower_bound(entry.first);
+                    if(it != map.end() && !map.key_comp()(entry.first, it->first))
+                    {
+                        it->second = combiner(it->second, entry.second);
+                    }
+                    else
+                    {
+                        map.emplace_hint(it, entry.first, std::move(entry.second));
+                    }
+                }
+            });
+            this->child->onNext(map);
+            this->child->onComplete();
+        }
+
+        KeySelectorType keySelector;
+        ValueSelectorType valueSelector;
+        ValuePrevSelectorType valuePrevSelector;
+        CombinerType combiner;
+        ThreadLocalPartials<PartialType> partials;
+        std::atomic<bool> terminated;
+    };
+
+public:
+    OperatorToMapConcurrent(const KeySelectorType& kSelector, const ValueSelectorType& vSelector,
+                            const ValuePrevSelectorType& vpSelector, const CombinerType& combiner) :
+        Operator<T, MapType>(), keySelector(kSelector), valueSelector(vSelector),
+        valuePrevSelector(vpSelector), combiner(combiner)
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<ToMapConcurrentSubscriber>(t, keySelector, valueSelector,
+                                                                valuePrevSelector, combiner);
         subs->addChildSubscriptionFromThis();
         return subs;
     }
@@ -65,6 +173,7 @@ private:
     KeySelectorType keySelector;
     ValueSelectorType valueSelector;
     ValuePrevSelectorType valuePrevSelector;
+    CombinerType combiner;
 };
 
 #endif // OPERATORTOMAP_HPP
@@ -0,0 +1,233 @@
+#ifndef OPERATORTOMAPINCREMENTAL_HPP
+#define OPERATORTOMAPINCREMENTAL_HPP
+#include "Operator.hpp"
+#include "../Scheduler.hpp"
+#include "../utils/MaterializedView.hpp"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template<typename T, typename KeySelector, typename ValueSelector>
+struct ToMapIncrementalTypes
+{
+    using KeyType     = typename std::decay<typename std::result_of<KeySelector(const T&)>::type>::type;
+    using ValueType   = typename std::decay<typename std::result_of<ValueSelector(const T&)>::type>::type;
+    using UpdateType  = std::pair<KeyType, ValueType>;
+    using BatchType   = std::vector<UpdateType>;
+    using ViewType    = MaterializedView<KeyType, ValueType>;
+    using ViewRefType = std::shared_ptr<ViewType>;
+};
+
+//toMap for streams that never end: the keyed state lives in a MaterializedView
+//and every value emits its key's new (key, value) right away.
+template<typename T, typename KeySelector, typename ValueSelector, typename ValuePrevSelector>
+class OperatorToMapIncremental : public Operator<T, typename ToMapIncrementalTypes<T,KeySelector,ValueSelector>::UpdateType>
+{
+    using Types                 = ToMapIncrementalTypes<T,KeySelector,ValueSelector>;
+public:
+    using UpdateType            = typename Types::UpdateType;
+    using ViewRefType           = typename Types::ViewRefType;
+private:
+    using KeyType               = typename Types::KeyType;
+    using ValueType             = typename Types::ValueType;
+    using SourceSubscriberType  = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType    = typename CompositeSubscriber<T, UpdateType>::ChildSubscriberType;
+    using KeySelectorType       = typename std::decay<KeySelector>::type;
+    using ValueSelectorType     = typename std::decay<ValueSelector>::type;
+    using ValuePrevSelectorType = typename std::decay<ValuePrevSelector>::type;
+
+    struct ToMapIncrementalSubscriber : public CompositeSubscriber<T, UpdateType>
+    {
+        ToMapIncrementalSubscriber(ThisSubscriberType p, const KeySelectorType& kSelector,
+                                   const ValueSelectorType& vSelector, const ValuePrevSelectorType& vpSelector,
+                                   const ViewRefType& view) :
+            CompositeSubscriber<T, UpdateType>(p), keySelector(kSelector), valueSelector(vSelector),
+            valuePrevSelector(vpSelector), view(view)
+        {}
+
+        void onNext(const T& t) override
+        {
+            KeyType key = keySelector(t);
+            ValueType value = view->update(key, valueSelector(t), valuePrevSelector);
+            this->child->onNext(UpdateType(std::move(key), std::move(value)));
+        }
+
+        KeySelectorType keySelector;
+        ValueSelectorType valueSelector;
+        ValuePrevSelectorType valuePrevSelector;
+        ViewRefType view;
+    };
+
+public:
+    OperatorToMapIncremental(const KeySelectorType& kSelector, const ValueSelectorType& vSelector,
+                             const ValuePrevSelectorType& vpSelector, const ViewRefType& view) :
+        keySelector(kSelector), valueSelector(vSelector), valuePrevSelector(vpSelector), view(view)
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        //Every subscription builds its own state unless the caller shares a view.
+        auto subs = std::make_shared<ToMapIncrementalSubscriber>(t, keySelector, valueSelector, valuePrevSelector,
+                                                                 view ? view : std::make_shared<typename Types::ViewType>());
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    KeySelectorType keySelector;
+    ValueSelectorType valueSelector;
+    ValuePrevSelectorType valuePrevSelector;
+    ViewRefType view;
+};
+
+//Same state, but the keys changed since the previous tick leave as one batch
+//per period, each key once with its latest value. Ticks skip the lock while
+//nothing changed; the last batch is flushed on completion.
+template<typename T, typename KeySelector, typename ValueSelector, typename ValuePrevSelector>
+class OperatorToMapIncrementalBatched : public Operator<T, typename ToMapIncrementalTypes<T,KeySelector,ValueSelector>::BatchType>
+{
+    using Types                 = ToMapIncrementalTypes<T,KeySelector,ValueSelector>;
+public:
+    using BatchType             = typename Types::BatchType;
+    using ViewRefType           = typename Types::ViewRefType;
+private:
+    using KeyType               = typename Types::KeyType;
+    using ValueType             = typename Types::ValueType;
+    using SourceSubscriberType  = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType    = typename CompositeSubscriber<T, BatchType>::ChildSubscriberType;
+    using KeySelectorType       = typename std::decay<KeySelector>::type;
+    using ValueSelectorType     = typename std::decay<ValueSelector>::type;
+    using ValuePrevSelectorType = typename std::decay<ValuePrevSelector>::type;
+
+    struct ToMapBatchedSubscriber : public CompositeSubscriber<T, BatchType>
+    {
+        ToMapBatchedSubscriber(ThisSubscriberType p, const KeySelectorType& kSelector,
+                               const ValueSelectorType& vSelector, const ValuePrevSelectorType& vpSelector,
+                               const ViewRefType& view, const Scheduler::SchedulerRefType& scheduler) :
+            CompositeSubscriber<T, BatchType>(p), keySelector(kSelector), valueSelector(vSelector),
+            valuePrevSelector(vpSelector), view(view), worker(scheduler->createWorker()),
+            hasChanges(false), done(false)
+        {}
+
+        void start(std::chrono::steady_clock::duration period)
+        {
+            //Weak reference, the periodic action lives as long as its subscription.
+            std::weak_ptr<ToMapBatchedSubscriber> weak =
+                    std::static_pointer_cast<ToMapBatchedSubscriber>(this->shared_from_this());
+            ticks = worker->schedulePeriodically(std::make_shared<Action0>([weak](){
+                if(auto self = weak.lock())
+                {
+                    self->tick();
+                }
+            }), period, period);
+            this->add(ticks);
+        }
+
+        void onNext(const T& t) override
+        {
+            KeyType key = keySelector(t);
+            ValueType value = view->update(key, valueSelector(t), valuePrevSelector);
+            std::lock_guard<std::mutex> l(lock);
+            changed[std::move(key)] = std::move(value);
+            hasChanges.store(true, std::memory_order_release);
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            finish();
+            this->child->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            flush();
+            finish();
+            this->child->onComplete();
+        }
+
+        void tick()
+        {
+            if(!hasChanges.load(std::memory_order_acquire))
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> l(lock);
+            if(!done)
+            {
+                flush();
+            }
+        }
+
+        //Called under the lock.
+        void flush()
+        {
+            if(changed.empty())
+            {
+                return;
+            }
+            BatchType batch;
+            batch.reserve(changed.size());
+            for(auto& entry : changed)
+            {
+                batch.emplace_back(entry.first, std::move(entry.second));
+            }
+            changed.clear();
+            hasChanges.store(false, std::memory_order_relaxed);
+            this->child->onNext(batch);
+        }
+
+        //Called under the lock.
+        void finish()
+        {
+            done = true;
+            changed.clear();
+            hasChanges.store(false);
+            ticks->unsubscribe();
+        }
+
+        KeySelectorType keySelector;
+        ValueSelectorType valueSelector;
+        ValuePrevSelectorType valuePrevSelector;
+        ViewRefType view;
+        Scheduler::WorkerRefType worker;
+        SubscriptionPtrType ticks;
+        std::mutex lock;
+        std::map<KeyType, ValueType> changed;
+        std::atomic<bool> hasChanges;
+        bool done;
+    };
+
+public:
+    template<typename Rep, typename Period>
+    OperatorToMapIncrementalBatched(const KeySelectorType& kSelector, const ValueSelectorType& vSelector,
+                                    const ValuePrevSelectorType& vpSelector,
+                                    const std::chrono::duration<Rep, Period>& period,
+                                    const ViewRefType& view, const Scheduler::SchedulerRefType& scheduler) :
+        keySelector(kSelector), valueSelector(vSelector), valuePrevSelector(vpSelector), view(view),
+        scheduler(scheduler), period(std::chrono::duration_cast<std::chrono::steady_clock::duration>(period))
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<ToMapBatchedSubscriber>(t, keySelector, valueSelector, valuePrevSelector,
+                                                             view ? view : std::make_shared<typename Types::ViewType>(),
+                                                             scheduler);
+        subs->addChildSubscriptionFromThis();
+        subs->start(period);
+        return subs;
+    }
+private:
+    KeySelectorType keySelector;
+    ValueSelectorType valueSelector;
+    ValuePrevSelectorType valuePrevSelector;
+    ViewRefType view;
+    Scheduler::SchedulerRefType scheduler;
+    std::chrono::steady_clock::duration period;
+};
+
+#endif // OPERATORTOMAPINCREMENTAL_HPP
@@ -0,0 +1,198 @@
+#ifndef OPERATORWINDOW_HPP
+#define OPERATORWINDOW_HPP
+#include "Operator.hpp"
+#include "UnicastOnSubscribe.hpp"
+#include "../Scheduler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+template<typename T>
+class Observable;
+
+//Splits the stream into consecutive windows of count values, each emitted as an
+//Observable when its first value arrives. A window can be subscribed once;
+//values reaching it earlier are kept until then.
+template<typename T>
+class OperatorWindow : public Operator<T, Observable<T>>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T, Observable<T>>::ChildSubscriberType;
+    using WindowType           = std::shared_ptr<UnicastOnSubscribe<T>>;
+
+    struct WindowSubscriber : public CompositeSubscriber<T, Observable<T>>
+    {
+        WindowSubscriber(ThisSubscriberType p, size_t count) :
+            CompositeSubscriber<T, Observable<T>>(p), count(count), size(0)
+        {}
+
+        void onNext(const T& t) override
+        {
+            if(!window)
+            {
+                window = std::make_shared<UnicastOnSubscribe<T>>();
+                this->child->onNext(Observable<T>(window));
+            }
+            window->onNext(t);
+            if(++size == count)
+            {
+                window->onComplete();
+                window.reset();
+                size = 0;
+            }
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            if(window)
+            {
+                window->onError(ex);
+            }
+            this->child->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            if(window)
+            {
+                window->onComplete();
+            }
+            this->child->onComplete();
+        }
+
+        const size_t count;
+        size_t size;
+        WindowType window;
+    };
+
+public:
+    OperatorWindow(size_t count) : count(std::max<size_t>(count, 1))
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<WindowSubscriber>(t, count);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    size_t count;
+};
+
+//Windows that open with a value and close timespan later, on the shared
+//scheduler timer. Window values and closing are ordered by the operator's lock.
+template<typename T>
+class OperatorWindowWithTime : public Operator<T, Observable<T>>
+{
+    using SourceSubscriberType = std::shared_ptr<Subscriber<T>>;
+    using ThisSubscriberType   = typename CompositeSubscriber<T, Observable<T>>::ChildSubscriberType;
+    using WindowType           = std::shared_ptr<UnicastOnSubscribe<T>>;
+
+    struct WindowWithTimeSubscriber : public CompositeSubscriber<T, Observable<T>>
+    {
+        WindowWithTimeSubscriber(ThisSubscriberType p, const Scheduler::SchedulerRefType& scheduler,
+                                 std::chrono::steady_clock::duration timespan) :
+            CompositeSubscriber<T, Observable<T>>(p), worker(scheduler->createWorker()),
+            timespan(timespan), done(false)
+        {}
+
+        void onNext(const T& t) override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            if(done)
+            {
+                return;
+            }
+            if(!window)
+            {
+                window = std::make_shared<UnicastOnSubscribe<T>>();
+                this->child->onNext(Observable<T>(window));
+                armTimer(window);
+            }
+            window->onNext(t);
+        }
+
+        void onError(std::exception_ptr ex) override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            done = true;
+            if(window)
+            {
+                window->onError(ex);
+                window.reset();
+            }
+            cancelTimer();
+            this->child->onError(ex);
+        }
+
+        void onComplete() override
+        {
+            std::lock_guard<std::mutex> l(lock);
+            done = true;
+            if(window)
+            {
+                window->onComplete();
+                window.reset();
+            }
+            cancelTimer();
+            this->child->onComplete();
+        }
+
+        //Weak references only, the timer is cancelled when the stream terminates.
+        void armTimer(const WindowType& window)
+        {
+            std::weak_ptr<WindowWithTimeSubscriber> weak =
+                    std::static_pointer_cast<WindowWithTimeSubscriber>(this->shared_from_this());
+            std::weak_ptr<UnicastOnSubscribe<T>> opened = window;
+            timer = worker->scheduleDelayed(std::make_shared<Action0>([weak, opened](){
+                auto self = weak.lock();
+                if(!self)
+                {
+                    return;
+                }
+                std::lock_guard<std::mutex> l(self->lock);
+                if(self->window && self->window == opened.lock())
+                {
+                    self->window->onComplete();
+                    self->window.reset();
+                }
+            }), timespan);
+        }
+
+        //Called under the lock.
+        void cancelTimer()
+        {
+            if(timer != nullptr)
+            {
+                timer->unsubscribe();
+                timer = nullptr;
+            }
+        }
+
+        Scheduler::WorkerRefType worker;
+        const std::chrono::steady_clock::duration timespan;
+        std::mutex lock;
+        WindowType window;
+        bool done;
+        SubscriptionPtrType timer;
+    };
+
+public:
+    template<typename Rep, typename Period>
+    OperatorWindowWithTime(const std::chrono::duration<Rep, Period>& timespan,
+                           const Scheduler::SchedulerRefType& scheduler) :
+        scheduler(scheduler), timespan(std::chrono::duration_cast<std::chrono::steady_clock::duration>(timespan))
+    {}
+
+    SourceSubscriberType operator()(const ThisSubscriberType& t) override
+    {
+        auto subs = std::make_shared<WindowWithTimeSubscriber>(t, scheduler, timespan);
+        subs->addChildSubscriptionFromThis();
+        return subs;
+    }
+private:
+    Scheduler::SchedulerRefType scheduler;
+    std::chrono::steady_clock::duration timespan;
+};
+
+#endif // OPERATORWINDOW_HPP
@@ -19,6 +19,18 @@ public:
         t->onComplete();
     }
 
+    bool isSynchronous() const override
+    {
+        return true;
+    }
+
+    void drainSync(const SyncConsumer<T>& consumer) override
+    {
+        T countInner(count);
+        for(T i = start; countInner > 0 && consumer(i); ++i, --countInner)
+        {}
+    }
+
 private:
     T start;
     T count;
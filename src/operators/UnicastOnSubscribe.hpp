@@ -0,0 +1,94 @@
+#ifndef UNICASTONSUBSCRIBE_HPP
+#define UNICASTONSUBSCRIBE_HPP
+#include "OnSubscribeBase.hpp"
+#include "../exceptions/TRExceptions.hpp"
+#include <mutex>
+#include <vector>
+
+//Source fed from outside that accepts a single subscriber. Events arriving
+//before the subscription are kept and replayed to it; a second subscriber gets
+//IllegalStateException.
+template<typename T>
+class UnicastOnSubscribe : public OnSubscribeBase<T>
+{
+public:
+    UnicastOnSubscribe() : completed(false)
+    {}
+
+    void operator()(const SubscriberPtrType<T>& s) override
+    {
+        std::lock_guard<std::mutex> l(lock);
+        if(subscriber)
+        {
+            s->onError(std::make_exception_ptr(IllegalStateException()));
+            return;
+        }
+        subscriber = s;
+        for(auto& t : pending)
+        {
+            if(subscriber->isUnsubscribe())
+            {
+                break;
+            }
+            subscriber->onNext(t);
+        }
+        pending.clear();
+        pending.shrink_to_fit();
+        if(error)
+        {
+            subscriber->onError(error);
+        }
+        else if(completed)
+        {
+            subscriber->onComplete();
+        }
+    }
+
+    void onNext(const T& t)
+    {
+        std::lock_guard<std::mutex> l(lock);
+        if(!subscriber)
+        {
+            pending.push_back(t);
+        }
+        else if(!subscriber->isUnsubscribe())
+        {
+            subscriber->onNext(t);
+        }
+    }
+
+    void onError(std::exception_ptr ex)
+    {
+        std::lock_guard<std::mutex> l(lock);
+        error = ex;
+        if(subscriber)
+        {
+            subscriber->onError(ex);
+        }
+    }
+
+    void onComplete()
+    {
+        std::lock_guard<std::mutex> l(lock);
+        completed = true;
+        if(subscriber)
+        {
+            subscriber->onComplete();
+        }
+    }
+
+    bool hasSubscriber()
+    {
+        std::lock_guard<std::mutex> l(lock);
+        return subscriber != nullptr;
+    }
+
+private:
+    std::mutex lock;
+    SubscriberPtrType<T> subscriber;
+    std::vector<T> pending;
+    std::exception_ptr error;
+    bool completed;
+};
+
+#endif // UNICASTONSUBSCRIBE_HPP
@@ -0,0 +1,105 @@
+#ifndef DEADLINESCHEDULER_HPP
+#define DEADLINESCHEDULER_HPP
+#include "../Scheduler.hpp"
+#include "../utils/DeadlineExecutor.hpp"
+#include "../exceptions/TRExceptions.hpp"
+#include <chrono>
+
+//What a DeadlineScheduler does with a task scheduled with an explicit deadline
+//and picked up after it. Plain schedule() calls, which include the drain tasks
+//of observeOn and friends, are never dropped or diverted: a lost drain would
+//leave its operator stalled.
+enum class MissedDeadlinePolicy
+{
+    Run,
+    Drop,
+    Divert
+};
+
+//Earliest-deadline-first pool. Actions scheduled with an explicit deadline are
+//ordered by it; plain schedule() calls get now + defaultBudget.
+class DeadlineScheduler : public Scheduler
+{
+protected:
+    class DeadlineWorker;
+public:
+    using Clock = DeadlineExecutor::Clock;
+
+    //Late tasks go to divertTo's worker when policy is Divert, which then needs one.
+    template<typename Rep, typename Period>
+    DeadlineScheduler(size_t poolSize, const std::chrono::duration<Rep, Period>& defaultBudget,
+                      MissedDeadlinePolicy policy = MissedDeadlinePolicy::Drop,
+                      const Scheduler::SchedulerRefType& divertTo = nullptr)
+    {
+        if(policy == MissedDeadlinePolicy::Divert && !divertTo)
+        {
+            throw NullPointerException();
+        }
+        pool = std::make_shared<DeadlineWorker>(poolSize, std::chrono::duration_cast<Clock::duration>(defaultBudget),
+                                                missedHandler(policy, divertTo));
+    }
+
+    WorkerRefType createWorker() override
+    {
+        return pool;
+    }
+
+    size_t missedDeadlines() const
+    {
+        return pool->executor.missedDeadlines();
+    }
+
+protected:
+    std::shared_ptr<DeadlineWorker> pool;
+
+    static DeadlineExecutor::MissedHandler missedHandler(MissedDeadlinePolicy policy,
+                                                         const Scheduler::SchedulerRefType& divertTo)
+    {
+        switch(policy)
+        {
+        case MissedDeadlinePolicy::Run:
+            return [](const ActionRefType& action){
+                (*action)();
+            };
+        case MissedDeadlinePolicy::Divert:
+        {
+            auto worker = divertTo->createWorker();
+            return [worker](const ActionRefType& action){
+                worker->schedule(action);
+            };
+        }
+        default:
+            return DeadlineExecutor::MissedHandler();
+        }
+    }
+
+    class DeadlineWorker : public Scheduler::Worker
+    {
+    public:
+        DeadlineWorker(size_t poolSize, Clock::duration defaultBudget, DeadlineExecutor::MissedHandler onMissed) :
+            defaultBudget(defaultBudget), executor(poolSize, std::move(onMissed))
+        {}
+
+        SubscriptionPtrType scheduleInteranal(ActionRefType action) override
+        {
+            executor.submit(action, Clock::now() + defaultBudget, false);
+            return nullptr;
+        }
+
+        SubscriptionPtrType scheduleWithDeadline(ActionRefType action, Clock::time_point deadline) override
+        {
+            executor.submit(action, deadline);
+            return nullptr;
+        }
+
+        bool isCurrentThread() override
+        {
+            return executor.isCurrentThread();
+        }
+
+        Clock::duration defaultBudget;
+        DeadlineExecutor executor;
+    };
+};
+
+#endif // DEADLINESCHEDULER_HPP
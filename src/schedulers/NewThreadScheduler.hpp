@@ -19,13 +19,27 @@ protected:
     {
     public:
         NewThreadWorker() : executor(1)
-        {}
+        {
+            //A compensating thread would run the next action while one blocks.
+            executor.setMaxCompensation(0);
+        }
 
         SubscriptionPtrType scheduleInteranal(ActionRefType action) override
         {
             executor.submit(action);
             return nullptr;
         }
+
+        SubscriptionPtrType schedulePrioritized(ActionRefType action, Priority priority) override
+        {
+            executor.submit(action, priority);
+            return nullptr;
+        }
+
+        bool isCurrentThread() override
+        {
+            return executor.isCurrentThread();
+        }
     private:
         ThreadPoolExecutor executor;
     };
@@ -0,0 +1,74 @@
+#ifndef PARTITIONEDSCHEDULER_HPP
+#define PARTITIONEDSCHEDULER_HPP
+#include "../Scheduler.hpp"
+#include "../utils/ThreadPoolExecutor.hpp"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+//Fixed set of single-threaded event loops. Work for one key hash always runs
+//on the same loop, so it is processed serially and in order.
+class PartitionedScheduler : public Scheduler
+{
+protected:
+    class PartitionWorker;
+public:
+    PartitionedScheduler(size_t partitionsCount) : next(0)
+    {
+        for(size_t i = 0; i < std::max<size_t>(partitionsCount, 1); ++i)
+        {
+            lanes.push_back(std::make_shared<PartitionWorker>());
+        }
+    }
+
+    WorkerRefType createWorker() override
+    {
+        return lanes[next++ % lanes.size()];
+    }
+
+    WorkerRefType createWorkerForKey(size_t keyHash) override
+    {
+        return lanes[keyHash % lanes.size()];
+    }
+
+    size_t partitions() const
+    {
+        return lanes.size();
+    }
+
+protected:
+    std::vector<std::shared_ptr<PartitionWorker>> lanes;
+    std::atomic<size_t> next;
+
+    class PartitionWorker : public Scheduler::Worker
+    {
+    public:
+        PartitionWorker() : executor(1)
+        {
+            //A lane blocking in blocking() must not hand its next action to a
+            //compensating thread: that would break the per-key order and affinity.
+            executor.setMaxCompensation(0);
+        }
+
+        SubscriptionPtrType scheduleInteranal(ActionRefType action) override
+        {
+            executor.submit(action);
+            return nullptr;
+        }
+
+        SubscriptionPtrType schedulePrioritized(ActionRefType action, Priority priority) override
+        {
+            executor.submit(action, priority);
+            return nullptr;
+        }
+
+        bool isCurrentThread() override
+        {
+            return executor.isCurrentThread();
+        }
+    private:
+        ThreadPoolExecutor executor;
+    };
+};
+
+#endif // PARTITIONEDSCHEDULER_HPP
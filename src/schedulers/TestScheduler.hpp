@@ -0,0 +1,133 @@
+#ifndef TESTSCHEDULER_HPP
+#define TESTSCHEDULER_HPP
+#include "../Scheduler.hpp"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+//Scheduler with a virtual clock for tests. Nothing runs until the clock is
+//moved with advanceBy/advanceTo (or triggerActions for actions that are due
+//now); due actions then run on the calling thread, in due-time order. The
+//clock starts at the epoch of steady_clock.
+class TestScheduler : public Scheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TestScheduler() : state(std::make_shared<State>())
+    {}
+
+    WorkerRefType createWorker() override
+    {
+        return std::make_shared<TestWorker>(state);
+    }
+
+    Clock::time_point now() const
+    {
+        std::lock_guard<std::mutex> l(state->mut);
+        return state->clock;
+    }
+
+    template<typename Rep, typename Period>
+    void advanceBy(const std::chrono::duration<Rep, Period>& delta)
+    {
+        advanceTo(now() + std::chrono::duration_cast<Clock::duration>(delta));
+    }
+
+    //Runs every action due up to time, moving the clock to each action's due
+    //time before running it. Actions scheduled meanwhile are run as well if due.
+    void advanceTo(Clock::time_point time)
+    {
+        std::unique_lock<std::mutex> l(state->mut);
+        while(!state->actions.empty() && state->actions.top().due <= time)
+        {
+            Timed next = state->actions.top();
+            state->actions.pop();
+            if(state->clock < next.due)
+            {
+                state->clock = next.due;
+            }
+            l.unlock();
+            (*next.action)();
+            l.lock();
+        }
+        if(state->clock < time)
+        {
+            state->clock = time;
+        }
+    }
+
+    void triggerActions()
+    {
+        advanceTo(now());
+    }
+
+    size_t pending() const
+    {
+        std::lock_guard<std::mutex> l(state->mut);
+        return state->actions.size();
+    }
+
+private:
+    struct Timed
+    {
+        Clock::time_point due;
+        uint64_t sequence;
+        ActionRefType action;
+    };
+
+    struct Later
+    {
+        bool operator()(const Timed& a, const Timed& b) const
+        {
+            return a.due != b.due ? a.due > b.due : a.sequence > b.sequence;
+        }
+    };
+
+    struct State
+    {
+        void push(ActionRefType action, Clock::time_point due)
+        {
+            std::lock_guard<std::mutex> l(mut);
+            actions.push(Timed{due, sequence++, std::move(action)});
+        }
+
+        mutable std::mutex mut;
+        Clock::time_point clock;
+        uint64_t sequence = 0;
+        std::priority_queue<Timed, std::vector<Timed>, Later> actions;
+    };
+
+    class TestWorker : public Scheduler::Worker
+    {
+    public:
+        TestWorker(std::shared_ptr<State> state) : state(std::move(state))
+        {}
+
+        Clock::time_point now() override
+        {
+            std::lock_guard<std::mutex> l(state->mut);
+            return state->clock;
+        }
+    protected:
+        SubscriptionPtrType scheduleInteranal(ActionRefType action) override
+        {
+            state->push(std::move(action), now());
+            return nullptr;
+        }
+
+        SubscriptionPtrType scheduleAt(ActionRefType action, Clock::time_point due) override
+        {
+            state->push(std::move(action), due);
+            return nullptr;
+        }
+    private:
+        std::shared_ptr<State> state;
+    };
+
+    std::shared_ptr<State> state;
+};
+
+#endif // TESTSCHEDULER_HPP
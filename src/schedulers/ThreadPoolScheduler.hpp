@@ -15,11 +15,44 @@ public:
         pool = std::make_shared<ThreadPoolWorker>(poolSize);
     }
 
+    template<typename Rep1, typename Period1, typename Rep2, typename Period2>
+    ThreadPoolScheduler(size_t minPoolSize, size_t maxPoolSize,
+                        const std::chrono::duration<Rep1, Period1>& growThreshold,
+                        const std::chrono::duration<Rep2, Period2>& keepAlive)
+    {
+        pool = std::make_shared<ThreadPoolWorker>(minPoolSize, maxPoolSize, growThreshold, keepAlive);
+    }
+
     WorkerRefType createWorker() override
     {
         return pool;
     }
 
+    size_t poolSize() const
+    {
+        return pool->executor.size();
+    }
+
+    size_t minPoolSize() const
+    {
+        return pool->executor.minimumSize();
+    }
+
+    size_t maxPoolSize() const
+    {
+        return pool->executor.maximumSize();
+    }
+
+    void resize(size_t minPoolSize, size_t maxPoolSize)
+    {
+        pool->executor.resize(minPoolSize, maxPoolSize);
+    }
+
+    void setPriorityWeights(const PriorityWeights& weights)
+    {
+        pool->executor.setPriorityWeights(weights);
+    }
+
 protected:
     std::shared_ptr<ThreadPoolWorker> pool;
 
@@ -29,12 +62,30 @@ protected:
         ThreadPoolWorker(size_t poolSize) : executor(poolSize)
         {}
 
+        template<typename Rep1, typename Period1, typename Rep2, typename Period2>
+        ThreadPoolWorker(size_t minPoolSize, size_t maxPoolSize,
+                         const std::chrono::duration<Rep1, Period1>& growThreshold,
+                         const std::chrono::duration<Rep2, Period2>& keepAlive) :
+            executor(minPoolSize, maxPoolSize, growThreshold, keepAlive)
+        {}
+
         SubscriptionPtrType scheduleInteranal(ActionRefType action) override
         {
              executor.submit(action);
              return nullptr;
         }
-    private:
+
+        SubscriptionPtrType schedulePrioritized(ActionRefType action, Priority priority) override
+        {
+            executor.submit(action, priority);
+            return nullptr;
+        }
+
+        bool isCurrentThread() override
+        {
+            return executor.isCurrentThread();
+        }
+
         ThreadPoolExecutor executor;
     };
 
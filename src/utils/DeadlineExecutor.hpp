@@ -0,0 +1,148 @@
+#ifndef DEADLINEEXECUTOR_HPP
+#define DEADLINEEXECUTOR_HPP
+
+#include "../Functions.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+//Fixed thread pool running tasks earliest-deadline-first. A task whose deadline
+//has already passed when a thread picks it up is not run; it is counted as missed
+//and handed to the missed-deadline handler instead (no handler drops it). Tasks
+//submitted with mayMiss false only use the deadline for ordering and always run.
+class DeadlineExecutor
+{
+public:
+    using Clock               = std::chrono::steady_clock;
+    using ScheduledActionType = ActionRefType;
+    using MissedHandler       = std::function<void(const ScheduledActionType&)>;
+
+    DeadlineExecutor(size_t size, MissedHandler onMissed = MissedHandler()) :
+        onMissed(std::move(onMissed)), done(false), sequence(0), missed(0)
+    {
+        for(size_t i = 0; i < size; ++i)
+        {
+            workers.push_back(std::thread(&DeadlineExecutor::run, this));
+        }
+    }
+
+    DeadlineExecutor(const DeadlineExecutor&) = delete;
+    DeadlineExecutor& operator = (const DeadlineExecutor&) = delete;
+
+    virtual ~DeadlineExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> l(mut);
+            done = true;
+        }
+        cond.notify_all();
+
+        auto self = std::this_thread::get_id();
+        for(auto& worker : workers)
+        {
+            if(worker.get_id() == self)
+            {
+                worker.detach();
+            }
+            else if(worker.joinable())
+            {
+                worker.join();
+            }
+        }
+    }
+
+    void submit(ScheduledActionType action, Clock::time_point deadline, bool mayMiss = true)
+    {
+        {
+            std::lock_guard<std::mutex> l(mut);
+            tasks.push(Task{deadline, sequence++, std::move(action), mayMiss});
+        }
+        cond.notify_one();
+    }
+
+    size_t missedDeadlines() const
+    {
+        return missed.load();
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> l(mut);
+        return tasks.size();
+    }
+
+    bool isCurrentThread() const
+    {
+        return currentExecutor() == this;
+    }
+
+private:
+    struct Task
+    {
+        Clock::time_point deadline;
+        uint64_t sequence;
+        ScheduledActionType action;
+        bool mayMiss;
+    };
+
+    //Earliest deadline on top, FIFO among equal deadlines.
+    struct Later
+    {
+        bool operator()(const Task& a, const Task& b) const
+        {
+            return a.deadline > b.deadline || (a.deadline == b.deadline && a.sequence > b.sequence);
+        }
+    };
+
+    static const DeadlineExecutor*& currentExecutor()
+    {
+        static thread_local const DeadlineExecutor* executor = nullptr;
+        return executor;
+    }
+
+    void run()
+    {
+        currentExecutor() = this;
+        while(true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> l(mut);
+                cond.wait(l, [&]{return done || !tasks.empty();});
+                if(done)
+                {
+                    return;
+                }
+                task = tasks.top();
+                tasks.pop();
+            }
+
+            if(task.mayMiss && Clock::now() > task.deadline)
+            {
+                ++missed;
+                if(onMissed)
+                {
+                    onMissed(task.action);
+                }
+                continue;
+            }
+            (*task.action)();
+        }
+    }
+
+    MissedHandler onMissed;
+    mutable std::mutex mut;
+    std::condition_variable cond;
+    std::priority_queue<Task, std::vector<Task>, Later> tasks;
+    bool done;
+    uint64_t sequence;
+    std::atomic<size_t> missed;
+    std::vector<std::thread> workers;
+};
+
+#endif // DEADLINEEXECUTOR_HPP
@@ -0,0 +1,81 @@
+#ifndef MPSCQUEUE_HPP
+#define MPSCQUEUE_HPP
+#include <atomic>
+#include <utility>
+
+//Unbounded lock-free multi-producer single-consumer queue (linked nodes, one
+//exchange per push). Any thread may push, only one thread at a time may pop.
+//A pop racing with a push may still see the queue empty; callers pair the
+//queue with a work-in-progress counter to catch up on such items.
+template<typename T>
+class MPSCQueue
+{
+public:
+    MPSCQueue() : head(new Node()), tail(head.load())
+    {}
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    ~MPSCQueue()
+    {
+        T value;
+        while(tryPop(value))
+        {}
+        delete tail;
+    }
+
+    void push(const T& value)
+    {
+        link(new Node(value));
+    }
+
+    void push(T&& value)
+    {
+        link(new Node(std::move(value)));
+    }
+
+    bool tryPop(T& value)
+    {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if(next == nullptr)
+        {
+            return false;
+        }
+        value = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+    //Consumer side only.
+    bool empty() const
+    {
+        return tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node
+    {
+        Node() : next(nullptr), value()
+        {}
+
+        template<typename V>
+        explicit Node(V&& v) : next(nullptr), value(std::forward<V>(v))
+        {}
+
+        std::atomic<Node*> next;
+        T value;
+    };
+
+    void link(Node* node)
+    {
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    std::atomic<Node*> head;
+    Node* tail;
+};
+
+#endif // MPSCQUEUE_HPP
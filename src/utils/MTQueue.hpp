@@ -49,7 +49,7 @@ public:
         {
             return false;
         }
-        value = data_queue.front();
+        value = std::move(data_queue.front());
         data_queue.pop();
         return true;
     }
@@ -70,7 +70,7 @@ public:
     {
         std::unique_lock<std::mutex> ul(mut);
         cond.wait(ul,[&]{return !data_queue.empty();});
-        value = data_queue.front();
+        value = std::move(data_queue.front());
         data_queue.pop();
     }
 
@@ -91,7 +91,7 @@ public:
         cond.wait_for(ul,timeout,[&]{return !data_queue.empty();});
         if(!data_queue.empty())
         {
-            value = data_queue.front();
+            value = std::move(data_queue.front());
             data_queue.pop();
             result = true;
         }
@@ -0,0 +1,99 @@
+#ifndef MAPUTIL_HPP
+#define MAPUTIL_HPP
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+template<typename M>
+struct is_ordered_map
+{
+    typedef char yes[1];
+    typedef char no[2];
+
+    template<typename C>
+    static yes& test(typename C::key_compare*);
+
+    template<typename C>
+    static no& test(...);
+
+    static const bool value = (sizeof(test<M>(0)) == sizeof(yes));
+};
+
+template<typename M>
+struct is_hashed_map
+{
+    typedef char yes[1];
+    typedef char no[2];
+
+    template<typename C>
+    static yes& test(typename C::hasher*);
+
+    template<typename C>
+    static no& test(...);
+
+    static const bool value = (sizeof(test<M>(0)) == sizeof(yes));
+};
+
+//Sizes the buckets of a hash map up front, so filling it never rehashes.
+template<typename M>
+typename std::enable_if<is_hashed_map<M>::value>::type
+mapReserve(M& map, size_t expectedSize)
+{
+    if(expectedSize > 0)
+    {
+        map.reserve(expectedSize);
+    }
+}
+
+template<typename M>
+typename std::enable_if<!is_hashed_map<M>::value>::type
+mapReserve(M&, size_t)
+{}
+
+//Stores merge(value, value) under a new key, or merge(value, previous) under a
+//known one, looking the key up only once. Returns the stored value.
+
+//Ordered maps: the descent finding the entry also yields the insertion hint.
+template<typename M, typename K, typename V, typename Merge>
+typename std::enable_if<is_ordered_map<M>::value, typename M::mapped_type&>::type
+mapUpsert(M& map, K&& key, const V& value, Merge& merge)
+{
+    auto it = map.lower_bound(key);
+    if(it != map.end() && !map.key_comp()(key, it->first))
+    {
+        it->second = merge(value, it->second);
+        return it->second;
+    }
+    return map.emplace_hint(it, std::forward<K>(key), merge(value, value))->second;
+}
+
+//Other maps: operator[] hashes the key once and only allocates for a new one;
+//a grown size tells the two cases apart.
+template<typename M, typename K, typename V, typename Merge>
+typename std::enable_if<!is_ordered_map<M>::value
+                        && std::is_default_constructible<typename M::mapped_type>::value,
+                        typename M::mapped_type&>::type
+mapUpsert(M& map, K&& key, const V& value, Merge& merge)
+{
+    size_t size = map.size();
+    auto& slot = map[std::forward<K>(key)];
+    slot = map.size() != size ? merge(value, value) : merge(value, slot);
+    return slot;
+}
+
+template<typename M, typename K, typename V, typename Merge>
+typename std::enable_if<!is_ordered_map<M>::value
+                        && !std::is_default_constructible<typename M::mapped_type>::value,
+                        typename M::mapped_type&>::type
+mapUpsert(M& map, K&& key, const V& value, Merge& merge)
+{
+    auto it = map.find(key);
+    if(it != map.end())
+    {
+        it->second = merge(value, it->second);
+        return it->second;
+    }
+    return map.emplace(std::forward<K>(key), merge(value, value)).first->second;
+}
+
+#endif // MAPUTIL_HPP
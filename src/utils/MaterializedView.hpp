@@ -0,0 +1,65 @@
+#ifndef MATERIALIZEDVIEW_HPP
+#define MATERIALIZEDVIEW_HPP
+#include "MapUtil.hpp"
+#include <map>
+#include <mutex>
+
+//Keyed state kept up to date by toMapIncremental, readable from any thread
+//while the stream runs. Point reads copy one value; snapshot() copies the map.
+template<typename K, typename V, typename MapType = std::map<K, V>>
+class MaterializedView
+{
+public:
+    MaterializedView() = default;
+    MaterializedView(const MaterializedView&) = delete;
+    MaterializedView& operator=(const MaterializedView&) = delete;
+
+    bool find(const K& key, V& value) const
+    {
+        std::lock_guard<std::mutex> l(lock);
+        auto it = map.find(key);
+        if(it == map.end())
+        {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+
+    MapType snapshot() const
+    {
+        std::lock_guard<std::mutex> l(lock);
+        return map;
+    }
+
+    //Visits the entries under the lock, keep f short.
+    template<typename F>
+    void forEach(F&& f) const
+    {
+        std::lock_guard<std::mutex> l(lock);
+        for(auto& entry : map)
+        {
+            f(entry.first, entry.second);
+        }
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> l(lock);
+        return map.size();
+    }
+
+    //Merges value into key's entry and returns the stored result.
+    template<typename Merge>
+    V update(const K& key, const V& value, Merge& merge)
+    {
+        std::lock_guard<std::mutex> l(lock);
+        return mapUpsert(map, K(key), value, merge);
+    }
+
+private:
+    mutable std::mutex lock;
+    MapType map;
+};
+
+#endif // MATERIALIZEDVIEW_HPP
@@ -0,0 +1,213 @@
+#ifndef OPENADDRESSINGMAP_HPP
+#define OPENADDRESSINGMAP_HPP
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+//Hash map with open addressing and linear probing over one flat power-of-two
+//table, so a lookup touches adjacent memory instead of chasing bucket nodes.
+//Hashes are spread with a multiplicative mix, which keeps identity hashes of
+//integers from clustering. Erased slots become tombstones, reused by inserts and
+//dropped when the table is rebuilt. Keys and values must be default
+//constructible. Not thread safe.
+template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class OpenAddressingMap
+{
+public:
+    OpenAddressingMap(size_t expected = 8) : count(0), tombstones(0)
+    {
+        rebuild(capacityFor(expected));
+    }
+
+    V* find(const K& key)
+    {
+        size_t index = lookup(key);
+        return slots[index].state == Slot::FULL ? &slots[index].value : nullptr;
+    }
+
+    //Inserts the value unless the key is present; returns the stored value.
+    V& insert(const K& key, V value)
+    {
+        size_t index = lookup(key);
+        if(slots[index].state == Slot::FULL)
+        {
+            return slots[index].value;
+        }
+        if((count + tombstones + 1) * 10 > slots.size() * 7)
+        {
+            //Grow when live entries fill a quarter of the table, else only drop tombstones.
+            rebuild((count + 1) * 4 > slots.size() ? slots.size() * 2 : slots.size());
+            index = lookup(key);
+        }
+        Slot& slot = slots[index];
+        if(slot.state == Slot::DELETED)
+        {
+            --tombstones;
+        }
+        slot.state = Slot::FULL;
+        slot.key = key;
+        slot.value = std::move(value);
+        ++count;
+        return slot.value;
+    }
+
+    bool erase(const K& key)
+    {
+        size_t index = lookup(key);
+        if(slots[index].state != Slot::FULL)
+        {
+            return false;
+        }
+        release(slots[index]);
+        return true;
+    }
+
+    //Erases every entry for which pred(key, value) holds; returns how many.
+    template<typename Predicate>
+    size_t eraseIf(Predicate pred)
+    {
+        size_t erased = 0;
+        for(auto& slot : slots)
+        {
+            if(slot.state == Slot::FULL && pred(slot.key, slot.value))
+            {
+                release(slot);
+                ++erased;
+            }
+        }
+        return erased;
+    }
+
+    template<typename F>
+    void forEach(F f)
+    {
+        for(auto& slot : slots)
+        {
+            if(slot.state == Slot::FULL)
+            {
+                f(slot.key, slot.value);
+            }
+        }
+    }
+
+    void reserve(size_t expected)
+    {
+        size_t capacity = capacityFor(expected);
+        if(capacity > slots.size())
+        {
+            rebuild(capacity);
+        }
+    }
+
+    void clear()
+    {
+        std::vector<Slot>(slots.size()).swap(slots);
+        count = 0;
+        tombstones = 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+private:
+    struct Slot
+    {
+        enum State : unsigned char { EMPTY, FULL, DELETED };
+
+        Slot() : state(EMPTY), key(), value()
+        {}
+
+        State state;
+        K key;
+        V value;
+    };
+
+    //Slot holding the key, or the slot an insert of it should use.
+    size_t lookup(const K& key) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t index = mix(hash(key)) & mask;
+        size_t firstFree = slots.size();
+        while(true)
+        {
+            const Slot& slot = slots[index];
+            if(slot.state == Slot::EMPTY)
+            {
+                return firstFree != slots.size() ? firstFree : index;
+            }
+            if(slot.state == Slot::DELETED)
+            {
+                if(firstFree == slots.size())
+                {
+                    firstFree = index;
+                }
+            }
+            else if(equal(slot.key, key))
+            {
+                return index;
+            }
+            index = (index + 1) & mask;
+        }
+    }
+
+    void release(Slot& slot)
+    {
+        slot.state = Slot::DELETED;
+        slot.key = K();
+        slot.value = V();
+        --count;
+        ++tombstones;
+    }
+
+    void rebuild(size_t capacity)
+    {
+        std::vector<Slot> old(capacity);
+        old.swap(slots);
+        count = 0;
+        tombstones = 0;
+        for(auto& slot : old)
+        {
+            if(slot.state == Slot::FULL)
+            {
+                Slot& target = slots[lookup(slot.key)];
+                target.state = Slot::FULL;
+                target.key = std::move(slot.key);
+                target.value = std::move(slot.value);
+                ++count;
+            }
+        }
+    }
+
+    static size_t capacityFor(size_t expected)
+    {
+        size_t capacity = 8;
+        while(capacity * 7 < expected * 10)
+        {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    static size_t mix(size_t h)
+    {
+        uint64_t x = static_cast<uint64_t>(h) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(x ^ (x >> 32));
+    }
+
+    std::vector<Slot> slots;
+    size_t count;
+    size_t tombstones;
+    Hash hash;
+    KeyEqual equal;
+};
+
+#endif // OPENADDRESSINGMAP_HPP
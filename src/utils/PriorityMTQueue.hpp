@@ -0,0 +1,144 @@
+#ifndef PRIORITYMTQUEUE
+#define PRIORITYMTQUEUE
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+
+enum class Priority : size_t
+{
+    Low = 0,
+    Normal = 1,
+    High = 2
+};
+
+const size_t PRIORITY_LANES = 3;
+
+using PriorityWeights = std::array<size_t, PRIORITY_LANES>;
+
+//MTQueue with one FIFO lane per Priority. By default the highest non-empty lane
+//is always served first; with weights set, lanes are served round-robin and each
+//one hands out up to its weight (at least one) of items per round, so low lanes cannot starve.
+template<typename T>
+class PriorityMTQueue
+{
+public:
+    PriorityMTQueue() : weights(), weighted(false), currentLane(PRIORITY_LANES - 1), credits(0), count(0)
+    {}
+
+    PriorityMTQueue(const PriorityMTQueue&) = delete;
+    PriorityMTQueue& operator=(const PriorityMTQueue&) = delete;
+
+    //Zero weights restore strict priority.
+    void setWeights(const PriorityWeights& w)
+    {
+        std::lock_guard<std::mutex> lk(mut);
+        weights = w;
+        weighted = false;
+        for(size_t weight : weights)
+        {
+            weighted = weighted || weight > 0;
+        }
+        credits = weights[currentLane];
+    }
+
+    void push(const T& dat, Priority priority = Priority::Normal)
+    {
+        std::lock_guard<std::mutex> lk(mut);
+        lanes[static_cast<size_t>(priority)].push(dat);
+        ++count;
+        cond.notify_one();
+    }
+
+    bool tryPop(T& value)
+    {
+        std::lock_guard<std::mutex> lk(mut);
+        return popLocked(value);
+    }
+
+    template<typename Rep, typename Period>
+    bool waitForAndPop(T& value, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        std::unique_lock<std::mutex> ul(mut);
+        cond.wait_for(ul, timeout, [&]{return count != 0;});
+        return popLocked(value);
+    }
+
+    bool empty() const
+    {
+        std::lock_guard<std::mutex> lk(mut);
+        return count == 0;
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lk(mut);
+        return count;
+    }
+
+    size_t size(Priority priority) const
+    {
+        std::lock_guard<std::mutex> lk(mut);
+        return lanes[static_cast<size_t>(priority)].size();
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lk(mut);
+        for(auto& lane : lanes)
+        {
+            std::queue<T> empty;
+            std::swap(lane, empty);
+        }
+        count = 0;
+    }
+
+private:
+    bool popLocked(T& value)
+    {
+        if(count == 0)
+        {
+            return false;
+        }
+
+        size_t lane = weighted ? nextWeightedLane() : highestLane();
+        value = lanes[lane].front();
+        lanes[lane].pop();
+        --count;
+        return true;
+    }
+
+    size_t highestLane() const
+    {
+        size_t lane = PRIORITY_LANES - 1;
+        while(lanes[lane].empty())
+        {
+            --lane;
+        }
+        return lane;
+    }
+
+    size_t nextWeightedLane()
+    {
+        while(lanes[currentLane].empty() || credits == 0)
+        {
+            currentLane = currentLane == 0 ? PRIORITY_LANES - 1 : currentLane - 1;
+            credits = std::max<size_t>(weights[currentLane], 1);
+        }
+        --credits;
+        return currentLane;
+    }
+
+    mutable std::mutex mut;
+    std::condition_variable cond;
+    std::array<std::queue<T>, PRIORITY_LANES> lanes;
+    PriorityWeights weights;
+    bool weighted;
+    size_t currentLane;
+    size_t credits;
+    size_t count;
+};
+
+#endif // PRIORITYMTQUEUE
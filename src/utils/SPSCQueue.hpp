@@ -0,0 +1,78 @@
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+#include <atomic>
+#include <memory>
+#include <utility>
+
+//Bounded lock-free single-producer single-consumer ring. The capacity is rounded
+//up to a power of two. One thread at a time may push and one may pop.
+template<typename T>
+class SPSCQueue
+{
+public:
+    SPSCQueue(size_t capacity) : mask(roundUp(capacity) - 1), buffer(new T[mask + 1]),
+        head(0), tail(0)
+    {}
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    bool tryPush(const T& value)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if(t - head.load(std::memory_order_acquire) > mask)
+        {
+            return false;
+        }
+        buffer[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& value)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if(h == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        value = std::move(buffer[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const
+    {
+        size_t h = head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - h;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+private:
+    static size_t roundUp(size_t n)
+    {
+        size_t c = 1;
+        while(c < n)
+        {
+            c <<= 1;
+        }
+        return c;
+    }
+
+    const size_t mask;
+    std::unique_ptr<T[]> buffer;
+    //Kept on separate cache lines, the producer and the consumer write one each.
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+#endif // SPSCQUEUE_HPP
@@ -0,0 +1,99 @@
+#ifndef THREADLOCALPARTIALS_HPP
+#define THREADLOCALPARTIALS_HPP
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//Per-thread partial results of one aggregation. A thread finds its partial
+//through a small thread-local cache, so accumulating takes no lock; the
+//registry is only locked when a thread misses the cache. It maps thread ids to
+//partials, so a thread running more live aggregations than the cache holds
+//finds its partial there again instead of starting another one. Partials are
+//read back once the producers are done.
+template<typename P>
+class ThreadLocalPartials
+{
+public:
+    ThreadLocalPartials() : id(nextId())
+    {}
+
+    ThreadLocalPartials(const ThreadLocalPartials&) = delete;
+    ThreadLocalPartials& operator=(const ThreadLocalPartials&) = delete;
+
+    P& local()
+    {
+        Cache& cache = threadCache();
+        for(auto& entry : cache.entries)
+        {
+            if(entry.owner == id)
+            {
+                return *entry.partial;
+            }
+        }
+
+        P* partial;
+        {
+            std::lock_guard<std::mutex> l(lock);
+            P*& slot = byThread[std::this_thread::get_id()];
+            if(slot == nullptr)
+            {
+                partials.emplace_back(new P());
+                slot = partials.back().get();
+            }
+            partial = slot;
+        }
+        Entry& entry = cache.entries[cache.next++ % CACHE_SIZE];
+        entry.owner = id;
+        entry.partial = partial;
+        return *partial;
+    }
+
+    template<typename F>
+    void forEach(F f)
+    {
+        std::lock_guard<std::mutex> l(lock);
+        for(auto& partial : partials)
+        {
+            f(*partial);
+        }
+    }
+
+private:
+    static const size_t CACHE_SIZE = 8;
+
+    //Ids are never reused, so a stale entry of a finished aggregation never matches.
+    struct Entry
+    {
+        uint64_t owner = 0;
+        P* partial = nullptr;
+    };
+
+    struct Cache
+    {
+        Entry entries[CACHE_SIZE];
+        size_t next = 0;
+    };
+
+    static Cache& threadCache()
+    {
+        static thread_local Cache cache;
+        return cache;
+    }
+
+    static uint64_t nextId()
+    {
+        static std::atomic<uint64_t> ids(0);
+        return ++ids;
+    }
+
+    const uint64_t id;
+    std::mutex lock;
+    std::vector<std::unique_ptr<P>> partials;
+    std::unordered_map<std::thread::id, P*> byThread;
+};
+
+#endif // THREADLOCALPARTIALS_HPP
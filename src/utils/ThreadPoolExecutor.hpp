@@ -2,22 +2,44 @@
 #define THREADPOOLEXECUTOR_HPP
 
 #include "../Functions.hpp"
-#include "MTQueue.hpp"
+#include "PriorityMTQueue.hpp"
 #include "../Subscription.hpp"
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <algorithm>
+#include <iterator>
+#include <chrono>
 
 class ThreadPoolExecutor
 {
 public:
     using ScheduledActionType = ActionRefType;
+    using Clock               = std::chrono::steady_clock;
 
-    ThreadPoolExecutor(size_t size) : done(false)
+    ThreadPoolExecutor(size_t size) : ThreadPoolExecutor(size, size,
+                                                         std::chrono::milliseconds(0),
+                                                         defaultTimeout())
+    {}
+
+    //Elastic pool: starts minSize threads, grows up to maxSize while queued
+    //tasks wait longer than growThreshold and shrinks back once extra threads
+    //stay idle for keepAlive.
+    template<typename Rep1, typename Period1, typename Rep2, typename Period2>
+    ThreadPoolExecutor(size_t minSize, size_t maxSize,
+                       const std::chrono::duration<Rep1, Period1>& growThreshold,
+                       const std::chrono::duration<Rep2, Period2>& keepAlive) :
+        done(false), blocked(0), compensating(0), maxCompensation(maxSize), idle(0),
+        coreSize(0), minSize(minSize), maxSize(std::max(minSize, maxSize)),
+        growThreshold(std::chrono::duration_cast<Clock::duration>(growThreshold)),
+        keepAlive(std::chrono::duration_cast<Clock::duration>(keepAlive)),
+        lastDequeue(Clock::now().time_since_epoch().count())
     {
-        for(size_t i = 0; i < size; ++i)
+        std::lock_guard<std::mutex> l(workersLock);
+        for(size_t i = 0; i < minSize; ++i)
         {
-            workers.push_back(std::thread(&ThreadPoolExecutor::run, this));
+            ++coreSize;
+            workers.push_back(std::thread(&ThreadPoolExecutor::run, this, false));
         }
     }
 
@@ -30,31 +52,42 @@ public:
     virtual ~ThreadPoolExecutor()
     {
         shutdown();
-        submitLock.lock();
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> l(workersLock);
+            threads.swap(workers);
+            std::move(retired.begin(), retired.end(), std::back_inserter(threads));
+            retired.clear();
+        }
 
-        for(size_t i = 0; i < workers.size(); ++i)
+        //Wake every worker so it sees the shutdown flag.
+        for(size_t i = 0; i < threads.size(); ++i)
         {
-            if(workers[i].joinable())
-            {
-                if(actions.size() > 0)
-                {
-                    workers[i].join();
-                }
-                else
-                {
-                    workers[i].detach();
-                }
-            }
+            actions.push(Task(), Priority::High);
         }
 
-        submitLock.unlock();
+        joinAll(threads);
     }
 
-    void submit(ScheduledActionType action)
+    void submit(ScheduledActionType action, Priority priority = Priority::Normal)
     {
+        auto now = Clock::now();
         submitLock.lock();
-        actions.push(action);
+        actions.push(Task(std::move(action), now), priority);
         submitLock.unlock();
+
+        //Every thread is busy and none took a task for a while: the queue stalls.
+        if(isElastic() && idle.load() == 0 &&
+                now.time_since_epoch().count() - lastDequeue.load() > growThreshold.count())
+        {
+            tryGrow();
+        }
+    }
+
+    //Serves priority lanes round-robin by weight instead of strictly by priority.
+    void setPriorityWeights(const PriorityWeights& weights)
+    {
+        actions.setWeights(weights);
     }
 
     void shutdown()
@@ -62,28 +95,271 @@ public:
         done.store(true);
     }
 
+    //Current number of threads, including compensating ones.
+    size_t size() const
+    {
+        return coreSize.load() + compensating.load();
+    }
+
+    //Configured bounds, whatever the current number of threads.
+    size_t minimumSize() const
+    {
+        return minSize.load();
+    }
+
+    size_t maximumSize() const
+    {
+        return maxSize.load();
+    }
+
+    //Changes the elastic bounds; missing threads up to the new minimum are started
+    //right away, surplus ones retire through the keep-alive.
+    void resize(size_t newMinSize, size_t newMaxSize)
+    {
+        std::lock_guard<std::mutex> l(workersLock);
+        minSize.store(newMinSize);
+        maxSize.store(std::max(newMinSize, newMaxSize));
+        while(!done.load() && coreSize.load() < newMinSize)
+        {
+            ++coreSize;
+            workers.push_back(std::thread(&ThreadPoolExecutor::run, this, false));
+        }
+    }
+
+    bool isCurrentThread() const
+    {
+        return currentExecutor() == this;
+    }
+
+    //Executor owning the calling thread, nullptr outside of any pool.
+    static ThreadPoolExecutor* current()
+    {
+        return currentExecutor();
+    }
+
+    //Upper bound of extra threads started while tasks are blocked. Executors
+    //backing a serial worker set it to 0.
+    void setMaxCompensation(size_t max)
+    {
+        std::lock_guard<std::mutex> l(workersLock);
+        maxCompensation = max;
+    }
+
+    //Called by a task before it blocks: starts a compensating worker unless
+    //an idle one is already available or the cap is reached.
+    void beginBlocking()
+    {
+        size_t nowBlocked = ++blocked;
+        if(compensating.load() >= nowBlocked)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> l(workersLock);
+        if(done.load() || compensating.load() >= nowBlocked || compensating.load() >= maxCompensation)
+        {
+            return;
+        }
+        ++compensating;
+        joinAll(retired);
+        workers.push_back(std::thread(&ThreadPoolExecutor::run, this, true));
+    }
+
+    void endBlocking()
+    {
+        --blocked;
+    }
+
 private:
+    static ThreadPoolExecutor*& currentExecutor()
+    {
+        static thread_local ThreadPoolExecutor* executor = nullptr;
+        return executor;
+    }
+
+    struct Task
+    {
+        Task() = default;
+        Task(ScheduledActionType action, Clock::time_point enqueued) :
+            action(std::move(action)), enqueued(enqueued)
+        {}
+
+        ScheduledActionType action;
+        Clock::time_point enqueued;
+    };
 
-    virtual void run()
+    static Clock::duration defaultTimeout()
     {
+        return std::chrono::seconds(2);
+    }
+
+    bool isElastic() const
+    {
+        return maxSize.load() > minSize.load();
+    }
+
+    virtual void run(bool compensatingWorker)
+    {
+        currentExecutor() = this;
+        auto timeout = compensatingWorker ? defaultTimeout() : keepAlive;
         while(true)
         {
-            ScheduledActionType action;
-            if(actions.waitForAndPop(action, std::chrono::seconds(TIMEOUT)))
+            Task task;
+            ++idle;
+            bool timedOut = !actions.waitForAndPop(task, timeout);
+            --idle;
+            if(task.action)
             {
-                (*action)();
+                onDequeue(task);
+                (*task.action)();
             }
             bool isDone = done.load();
             if(isDone)
             {
                 return;
             }
+            if(timedOut && tryRetire(compensatingWorker))
+            {
+                return;
+            }
         }
     }
+
+    void onDequeue(const Task& task)
+    {
+        if(!isElastic())
+        {
+            return;
+        }
+        auto now = Clock::now();
+        lastDequeue.store(now.time_since_epoch().count());
+        if(now - task.enqueued > growThreshold)
+        {
+            tryGrow();
+        }
+    }
+
+    void tryGrow()
+    {
+        std::lock_guard<std::mutex> l(workersLock);
+        if(done.load() || coreSize.load() >= maxSize.load())
+        {
+            return;
+        }
+        ++coreSize;
+        joinAll(retired);
+        workers.push_back(std::thread(&ThreadPoolExecutor::run, this, false));
+    }
+
+    //Called after an idle timeout. A compensating worker leaves once fewer tasks
+    //are blocked than there are compensating workers, a regular one while the
+    //pool is above its minimum size.
+    bool tryRetire(bool compensatingWorker)
+    {
+        std::lock_guard<std::mutex> l(workersLock);
+        if(done.load())
+        {
+            return false;
+        }
+        if(compensatingWorker)
+        {
+            if(compensating.load() <= blocked.load())
+            {
+                return false;
+            }
+            --compensating;
+        }
+        else
+        {
+            if(coreSize.load() <= minSize.load())
+            {
+                return false;
+            }
+            --coreSize;
+        }
+
+        auto self = std::this_thread::get_id();
+        for(auto it = workers.begin(); it != workers.end(); ++it)
+        {
+            if(it->get_id() == self)
+            {
+                retired.push_back(std::move(*it));
+                workers.erase(it);
+                break;
+            }
+        }
+        return true;
+    }
+
+    static void joinAll(std::vector<std::thread>& threads)
+    {
+        auto self = std::this_thread::get_id();
+        for(size_t i = 0; i < threads.size(); ++i)
+        {
+            if(!threads[i].joinable())
+            {
+                continue;
+            }
+            if(threads[i].get_id() == self)
+            {
+                threads[i].detach();
+            }
+            else
+            {
+                threads[i].join();
+            }
+        }
+        threads.clear();
+    }
+
     std::mutex submitLock;
+    std::mutex workersLock;
     std::atomic<bool> done;
-    MTQueue<ScheduledActionType> actions;
+    std::atomic<size_t> blocked;
+    std::atomic<size_t> compensating;
+    size_t maxCompensation;
+    std::atomic<size_t> idle;
+    std::atomic<size_t> coreSize;
+    std::atomic<size_t> minSize;
+    std::atomic<size_t> maxSize;
+    const Clock::duration growThreshold;
+    const Clock::duration keepAlive;
+    std::atomic<Clock::rep> lastDequeue;
+    PriorityMTQueue<Task> actions;
     std::vector<std::thread> workers;
-    const int TIMEOUT = 2;
+    std::vector<std::thread> retired;
 };
+
+//Marks the scope of a blocking call made from a pool task, letting the pool
+//compensate with an extra worker for its duration. No-op outside of a pool.
+class ManagedBlocker
+{
+public:
+    ManagedBlocker() : executor(ThreadPoolExecutor::current())
+    {
+        if(executor)
+        {
+            executor->beginBlocking();
+        }
+    }
+
+    ManagedBlocker(const ManagedBlocker&) = delete;
+    ManagedBlocker& operator = (const ManagedBlocker&) = delete;
+
+    ~ManagedBlocker()
+    {
+        if(executor)
+        {
+            executor->endBlocking();
+        }
+    }
+private:
+    ThreadPoolExecutor* executor;
+};
+
+template<typename F>
+auto blocking(F&& fn) -> decltype(fn())
+{
+    ManagedBlocker blocker;
+    return fn();
+}
 #endif // THREADPOOLEXECUTOR_HPP
@@ -0,0 +1,192 @@
+#ifndef TIMERQUEUE_HPP
+#define TIMERQUEUE_HPP
+
+#include "../Functions.hpp"
+#include "../Subscription.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//One thread shared by every delayed action in the process. Actions run on the
+//timer thread when they are due, so they should only hand work over to a
+//worker. schedule() returns a handle: unsubscribing it releases the action at
+//once, and the slot it leaves in the heap is reclaimed when it comes up or by a
+//purge once cancelled slots make up half of the heap.
+class TimerQueue
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static TimerQueue& instance()
+    {
+        static TimerQueue timer;
+        return timer;
+    }
+
+    TimerQueue() : done(false), sequence(0), cancelled(0), thread(&TimerQueue::run, this)
+    {}
+
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator = (const TimerQueue&) = delete;
+
+    ~TimerQueue()
+    {
+        {
+            std::lock_guard<std::mutex> l(mut);
+            done = true;
+        }
+        cond.notify_one();
+        if(thread.get_id() == std::this_thread::get_id())
+        {
+            thread.detach();
+        }
+        else if(thread.joinable())
+        {
+            thread.join();
+        }
+    }
+
+    SubscriptionPtrType schedule(ActionRefType action, Clock::time_point due)
+    {
+        auto entry = std::make_shared<Entry>(*this, std::move(action));
+        bool earliest;
+        {
+            std::lock_guard<std::mutex> l(mut);
+            earliest = timers.empty() || due < timers.front().due;
+            timers.push_back(Timer{due, sequence++, entry});
+            std::push_heap(timers.begin(), timers.end(), Later());
+        }
+        if(earliest)
+        {
+            cond.notify_one();
+        }
+        return entry;
+    }
+
+    //Timers neither run nor cancelled yet.
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> l(mut);
+        return timers.size() - cancelled;
+    }
+
+private:
+    class Entry : public SubscriptionBase
+    {
+    public:
+        Entry(TimerQueue& queue, ActionRefType action) : queue(queue), action(std::move(action))
+        {}
+
+        bool isUnsubscribe() override
+        {
+            std::lock_guard<std::mutex> l(queue.mut);
+            return action == nullptr;
+        }
+
+        void unsubscribe() override
+        {
+            queue.cancel(*this);
+        }
+    private:
+        friend class TimerQueue;
+        TimerQueue& queue;
+        //Guarded by the queue's lock, null once run or cancelled.
+        ActionRefType action;
+    };
+
+    struct Timer
+    {
+        Clock::time_point due;
+        uint64_t sequence;
+        std::shared_ptr<Entry> entry;
+    };
+
+    //Earliest due first, equal times in submission order.
+    struct Later
+    {
+        bool operator()(const Timer& a, const Timer& b) const
+        {
+            return a.due != b.due ? a.due > b.due : a.sequence > b.sequence;
+        }
+    };
+
+    static const size_t PURGE_THRESHOLD = 64;
+
+    void cancel(Entry& entry)
+    {
+        ActionRefType released;
+        {
+            std::lock_guard<std::mutex> l(mut);
+            if(entry.action == nullptr)
+            {
+                return;
+            }
+            released = std::move(entry.action);
+            entry.action = nullptr;
+            ++cancelled;
+            if(cancelled >= PURGE_THRESHOLD && cancelled * 2 >= timers.size())
+            {
+                purge();
+            }
+        }
+        //Destroyed outside the lock, the action may own subscriptions of its own.
+        released.reset();
+    }
+
+    //Called under the lock.
+    void purge()
+    {
+        timers.erase(std::remove_if(timers.begin(), timers.end(), [](const Timer& timer){
+            return timer.entry->action == nullptr;
+        }), timers.end());
+        std::make_heap(timers.begin(), timers.end(), Later());
+        cancelled = 0;
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> l(mut);
+        while(!done)
+        {
+            if(timers.empty())
+            {
+                cond.wait(l);
+                continue;
+            }
+            auto due = timers.front().due;
+            if(Clock::now() < due)
+            {
+                cond.wait_until(l, due);
+                continue;
+            }
+            std::pop_heap(timers.begin(), timers.end(), Later());
+            std::shared_ptr<Entry> entry = std::move(timers.back().entry);
+            timers.pop_back();
+            if(entry->action == nullptr)
+            {
+                --cancelled;
+                continue;
+            }
+            ActionRefType action = std::move(entry->action);
+            entry->action = nullptr;
+            l.unlock();
+            (*action)();
+            action.reset();
+            l.lock();
+        }
+    }
+
+    mutable std::mutex mut;
+    std::condition_variable cond;
+    bool done;
+    uint64_t sequence;
+    size_t cancelled;
+    std::vector<Timer> timers;
+    std::thread thread;
+};
+
+#endif // TIMERQUEUE_HPP
@@ -1,5 +1,7 @@
 #ifndef UTIL
 #define UTIL
+#include <cstddef>
+#include <iterator>
 #include <memory>
 #include <type_traits>
 
@@ -32,5 +34,20 @@ auto resolveConteinerValueType(const T& t) -> decltype(*std::begin(t))
     return *std::begin(t);
 }
 
+//Compile-time list of indexes, for unpacking tuples (std::index_sequence is C++14).
+template<size_t... I>
+struct IndexSequence
+{};
+
+template<size_t N, size_t... I>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...>
+{};
+
+template<size_t... I>
+struct MakeIndexSequence<0, I...>
+{
+    using type = IndexSequence<I...>;
+};
+
 #endif // UTIL
 
@@ -2,10 +2,15 @@
 #include <string>
 #include <sstream>
 #include <memory>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <numeric>
 #include "Observable.hpp"
 #include "SchedulersFactory.hpp"
 #include <gtest/gtest.h>
 #include "Util.hpp"
+#include "TestScheduler.hpp"
 
 using namespace std;
 
@@ -529,6 +534,99 @@ TEST(RxCppTest, ToMapKVPSelector)
     ASSERT_EQ(11, v1);
 }
 
+TEST(RxCppTest, ToUnorderedMap)
+{
+    auto values = Observable<>::range(0, 1000);
+
+    size_t size = 0;
+    int sum = 0;
+    values.toUnorderedMap([](const int& i){
+        return i % 10;
+    }, [](const int& i){
+        return i;
+    }, [](const int& value, const int& prev){
+        return value + prev;
+    }, 10).subscribe([&](const std::unordered_map<int, int>& m){
+        size = m.size();
+        sum = m.at(3);
+    });
+
+    ASSERT_EQ(10u, size);
+    //first insertion stores value + value
+    ASSERT_EQ(49800 + 3, sum);
+
+    using Descending = std::map<char, size_t, std::greater<char>>;
+    std::string order;
+    Observable<>::just(std::string("bb"), std::string("a"), std::string("ccc")).toMapAs<Descending>([](const std::string& s){
+        return s.at(0);
+    }, [](const std::string& s){
+        return s.length();
+    }, [](const size_t& value, const size_t&){
+        return value;
+    }).subscribe([&](const Descending& m){
+        for(auto& entry : m)
+        {
+            order += entry.first;
+        }
+    });
+
+    ASSERT_EQ("cba", order);
+}
+
+TEST(RxCppTest, ToMapIncremental)
+{
+    Observable<std::string>::ThisSubscriberPtrType subject;
+    auto source = Observable<std::string>::create([&](const Observable<std::string>::ThisSubscriberPtrType& t){
+        subject = t;
+    });
+    auto key = [](const std::string& s){
+        return s.at(0);
+    };
+    auto length = [](const std::string& s){
+        return int(s.size());
+    };
+    auto longest = [](const int& value, const int& prev){
+        return std::max(value, prev);
+    };
+
+    std::vector<std::pair<char, int>> updates;
+    auto view = std::make_shared<MaterializedView<char, int>>();
+    source.toMapIncremental(key, length, longest, view).subscribe([&](const std::pair<char, int>& update){
+        updates.push_back(update);
+    });
+    subject->onNext("a");
+    subject->onNext("b");
+    subject->onNext("ab");
+    ASSERT_EQ((std::vector<std::pair<char, int>>{{'a', 1}, {'b', 1}, {'a', 2}}), updates);
+    int a = 0;
+    ASSERT_TRUE(view->find('a', a));
+    ASSERT_EQ(2, a);
+    ASSERT_EQ((std::map<char, int>{{'a', 2}, {'b', 1}}), view->snapshot());
+
+    auto scheduler = std::make_shared<TestScheduler>();
+    std::vector<std::vector<std::pair<char, int>>> batches;
+    bool complete = false;
+    source.toMapIncremental(key, length, longest, std::chrono::milliseconds(10), nullptr, scheduler)
+            .subscribe([&](const std::vector<std::pair<char, int>>& batch){
+        batches.push_back(batch);
+    }, [&](){
+        complete = true;
+    });
+    subject->onNext("a");
+    subject->onNext("b");
+    subject->onNext("abc");
+    scheduler->advanceBy(std::chrono::milliseconds(10));
+    scheduler->advanceBy(std::chrono::milliseconds(10));
+    subject->onNext("c");
+    subject->onComplete();
+    ASSERT_EQ(2u, batches.size());
+    ASSERT_EQ((std::vector<std::pair<char, int>>{{'a', 3}, {'b', 1}}), batches[0]);
+    ASSERT_EQ((std::vector<std::pair<char, int>>{{'c', 1}}), batches[1]);
+    ASSERT_TRUE(complete);
+    scheduler->advanceBy(std::chrono::milliseconds(100));
+    ASSERT_EQ(0u, scheduler->pending());
+}
+
 TEST(RxCppTest, ConcatMap)
 {
     auto mapper = [](const int& i){
@@ -606,6 +704,1621 @@ TEST(RxCppTest, Repeat)
 }
 
 
+TEST(RxCppTest, ObserveOnSameSchedulerRunsInline)
+{
+    auto pool = SchedulersFactory::instance().threadPoolScheduler();
+    std::atomic<bool> complete(false);
+    std::thread::id producerThread;
+    std::vector<std::thread::id> consumerThreads;
+    std::vector<int> result;
+
+    Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t)
+    {
+        producerThread = std::this_thread::get_id();
+        t->onNext(1);
+        t->onNext(2);
+        t->onComplete();
+    }).subscribeOn(pool)
+      .observeOn(pool)
+      .subscribe([&](const int& i){
+        consumerThreads.push_back(std::this_thread::get_id());
+        result.push_back(i);
+    }, [&](){
+        complete.store(true);
+    });
+
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_TRUE(complete.load());
+    ASSERT_EQ(2, result.size());
+    ASSERT_EQ(1, result[0]);
+    ASSERT_EQ(2, result[1]);
+    ASSERT_EQ(producerThread, consumerThreads[0]);
+    ASSERT_EQ(producerThread, consumerThreads[1]);
+}
+
+TEST(RxCppTest, ObserveOnInlineInsideTrampoline)
+{
+    auto pool = SchedulersFactory::instance().threadPoolScheduler();
+    std::atomic<bool> complete(false);
+    std::vector<int> result;
+
+    //subscribeOn() runs the source through the trampoline, so these values take the queue.
+    auto worker = pool->createWorker();
+    worker->schedule(std::make_shared<Action0>([&](){
+        Observable<>::range(0, 5).map([](const int& i){
+            return i * 10;
+        }).subscribeOn(pool).observeOn(pool).subscribe([&](const int& i){
+            result.push_back(i);
+        }, [&](){
+            complete.store(true);
+        });
+    }));
+
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_TRUE(complete.load());
+    ASSERT_EQ(std::vector<int>({0, 10, 20, 30, 40}), result);
+
+    //A value emitted under a busy trampoline stays ahead of the next one, even
+    //when that one arrives from another thread while the trampoline still runs.
+    Observable<int>::ThisSubscriberPtrType subject;
+    std::mutex lock;
+    std::vector<int> ordered;
+    std::atomic<bool> firstSent(false);
+    std::atomic<bool> secondSent(false);
+    std::atomic<bool> taskDone(false);
+    complete.store(false);
+    Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        subject = t;
+    }).observeOn(pool).subscribe([&](const int& i){
+        std::lock_guard<std::mutex> l(lock);
+        ordered.push_back(i);
+    }, [&](){
+        complete.store(true);
+    });
+    worker->schedule(std::make_shared<Action0>([&](){
+        Trampoline::run([&](){
+            subject->onNext(1);
+            firstSent.store(true);
+            for(int i = 0; i < 20 && !secondSent.load(); ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        });
+        taskDone.store(true);
+    }));
+    for(int i = 0; i < 500 && !firstSent.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    subject->onNext(2);
+    secondSent.store(true);
+    subject->onComplete();
+    for(int i = 0; i < 500 && !(complete.load() && taskDone.load()); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(complete.load());
+    ASSERT_TRUE(taskDone.load());
+    std::lock_guard<std::mutex> l(lock);
+    ASSERT_EQ(std::vector<int>({1, 2}), ordered);
+
+    //A throwing action still lets the actions queued behind it run.
+    bool queuedRan = false;
+    ASSERT_THROW(Trampoline::run([&](){
+        Trampoline::run([&](){
+            queuedRan = true;
+        });
+        throw some_exception(1);
+    }), some_exception);
+    ASSERT_TRUE(queuedRan);
+}
+
+TEST(RxCppTest, ManagedBlocking)
+{
+    ThreadPoolExecutor executor(1);
+    std::atomic<bool> released(false);
+    std::atomic<bool> finished(false);
+
+    executor.submit(std::make_shared<Action0>([&](){
+        blocking([&](){
+            for(int i = 0; i < 500 && !released.load(); ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        });
+        finished.store(true);
+    }));
+    executor.submit(std::make_shared<Action0>([&](){
+        released.store(true);
+    }));
+
+    for(int i = 0; i < 500 && !finished.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_TRUE(finished.load());
+    ASSERT_TRUE(released.load());
+
+    //A serial worker never runs a second action while one blocks.
+    auto worker = SchedulersFactory::instance().newThread()->createWorker();
+    std::atomic<int> running(0);
+    std::atomic<int> maxRunning(0);
+    std::atomic<int> done(0);
+    auto track = [&](){
+        int now = ++running;
+        int prev = maxRunning.load();
+        while(prev < now && !maxRunning.compare_exchange_weak(prev, now))
+        {}
+    };
+    worker->schedule(std::make_shared<Action0>([&](){
+        track();
+        blocking([](){
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        });
+        --running;
+        ++done;
+    }));
+    worker->schedule(std::make_shared<Action0>([&](){
+        track();
+        --running;
+        ++done;
+    }));
+    for(int i = 0; i < 500 && done.load() < 2; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(2, done.load());
+    ASSERT_EQ(1, maxRunning.load());
+}
+
+TEST(RxCppTest, ElasticThreadPool)
+{
+    ThreadPoolExecutor executor(1, 4, std::chrono::milliseconds(1), std::chrono::milliseconds(50));
+    std::atomic<int> finished(0);
+    size_t maxSize = executor.size();
+
+    for(int i = 0; i < 8; ++i)
+    {
+        executor.submit(std::make_shared<Action0>([&](){
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            ++finished;
+        }));
+    }
+
+    for(int i = 0; i < 500 && finished.load() < 8; ++i)
+    {
+        maxSize = std::max(maxSize, executor.size());
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    ASSERT_EQ(8, finished.load());
+    ASSERT_GT(maxSize, 1);
+    ASSERT_LE(maxSize, 4);
+
+    for(int i = 0; i < 500 && executor.size() > 1; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(1, executor.size());
+
+    //The factory compares requested sizes with the configured bounds, not the
+    //live thread count, and keeps the configured maximum.
+    auto pool = std::static_pointer_cast<ThreadPoolScheduler>(SchedulersFactory::instance().threadPoolScheduler());
+    size_t minSize = pool->minPoolSize();
+    pool->resize(minSize, minSize + 4);
+    SchedulersFactory::instance().threadPoolScheduler(minSize);
+    ASSERT_EQ(minSize, pool->minPoolSize());
+    ASSERT_EQ(minSize + 4, pool->maxPoolSize());
+    SchedulersFactory::instance().threadPoolScheduler(minSize + 1);
+    ASSERT_EQ(minSize + 1, pool->minPoolSize());
+    ASSERT_EQ(minSize + 4, pool->maxPoolSize());
+    //Back to the original bounds, the extra thread retires through the keep-alive.
+    pool->resize(minSize, minSize);
+}
+
+TEST(RxCppTest, ObserveOnPartitioned)
+{
+    auto scheduler = std::make_shared<PartitionedScheduler>(4);
+    std::atomic<bool> complete(false);
+    std::mutex lock;
+    std::map<int, std::vector<int>> valuesByKey;
+    std::map<int, std::set<std::thread::id>> threadsByKey;
+
+    Observable<>::range(0, 300)
+            .observeOn(scheduler, [](const int& i){ return i % 3; })
+            .subscribe([&](const int& i){
+        //Blocking lanes still process their keys serially, on their own thread.
+        if(i % 50 == 0)
+        {
+            blocking([](){
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            });
+        }
+        std::lock_guard<std::mutex> l(lock);
+        valuesByKey[i % 3].push_back(i);
+        threadsByKey[i % 3].insert(std::this_thread::get_id());
+    }, [&](){
+        complete.store(true);
+    });
+
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_TRUE(complete.load());
+    std::lock_guard<std::mutex> l(lock);
+    ASSERT_EQ(3, valuesByKey.size());
+    for(auto& kv : valuesByKey)
+    {
+        ASSERT_EQ(100, kv.second.size());
+        ASSERT_TRUE(std::is_sorted(kv.second.begin(), kv.second.end()));
+        ASSERT_EQ(1, threadsByKey[kv.first].size());
+    }
+
+    //A partitioned scheduler with a non-selector argument takes the plain observeOn overloads.
+    std::atomic<int> count(0);
+    complete.store(false);
+    Observable<>::range(0, 10).observeOn(scheduler, Priority::High).subscribe([&](const int&){
+        ++count;
+    }, [&](){
+        complete.store(true);
+    });
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(complete.load());
+    ASSERT_EQ(10, count.load());
+}
+
+TEST(RxCppTest, PriorityLanes)
+{
+    ThreadPoolExecutor executor(1);
+    std::atomic<bool> released(false);
+    std::mutex lock;
+    std::vector<int> order;
+
+    executor.submit(std::make_shared<Action0>([&](){
+        while(!released.load())
+        {
+            std::this_thread::yield();
+        }
+    }));
+    for(int i = 0; i < 3; ++i)
+    {
+        executor.submit(std::make_shared<Action0>([&, i](){
+            std::lock_guard<std::mutex> l(lock);
+            order.push_back(i);
+        }), Priority::Low);
+    }
+    executor.submit(std::make_shared<Action0>([&](){
+        std::lock_guard<std::mutex> l(lock);
+        order.push_back(100);
+    }), Priority::High);
+    released.store(true);
+
+    for(int i = 0; i < 500; ++i)
+    {
+        {
+            std::lock_guard<std::mutex> l(lock);
+            if(order.size() == 4)
+            {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::lock_guard<std::mutex> l(lock);
+    ASSERT_EQ(4, order.size());
+    ASSERT_EQ(100, order[0]);
+    ASSERT_EQ(0, order[1]);
+    ASSERT_EQ(1, order[2]);
+    ASSERT_EQ(2, order[3]);
+
+    PriorityMTQueue<int> queue;
+    PriorityWeights weights = {{1, 0, 2}};
+    queue.setWeights(weights);
+    for(int i = 0; i < 3; ++i)
+    {
+        queue.push(i, Priority::Low);
+        queue.push(10 + i, Priority::High);
+    }
+    std::vector<int> weighted;
+    int v;
+    while(queue.tryPop(v))
+    {
+        weighted.push_back(v);
+    }
+    ASSERT_EQ(std::vector<int>({10, 11, 0, 12, 1, 2}), weighted);
+}
+
+TEST(RxCppTest, DeadlineScheduler)
+{
+    auto scheduler = std::make_shared<DeadlineScheduler>(1, std::chrono::seconds(10));
+    auto worker = scheduler->createWorker();
+    auto now = std::chrono::steady_clock::now();
+    std::atomic<bool> released(false);
+    std::atomic<int> finished(0);
+    std::mutex lock;
+    std::vector<int> order;
+
+    auto record = [&](int i){
+        return std::make_shared<Action0>([&, i](){
+            std::lock_guard<std::mutex> l(lock);
+            order.push_back(i);
+            ++finished;
+        });
+    };
+
+    std::atomic<bool> started(false);
+    worker->schedule(std::make_shared<Action0>([&](){
+        started.store(true);
+        while(!released.load())
+        {
+            std::this_thread::yield();
+        }
+    }));
+    while(!started.load())
+    {
+        std::this_thread::yield();
+    }
+    worker->schedule(record(1), now + std::chrono::seconds(2));
+    worker->schedule(record(2), now + std::chrono::milliseconds(10));
+    worker->schedule(record(3), now + std::chrono::seconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    released.store(true);
+
+    for(int i = 0; i < 500 && finished.load() < 2; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::lock_guard<std::mutex> l(lock);
+    ASSERT_EQ(std::vector<int>({3, 1}), order);
+    ASSERT_EQ(1, scheduler->missedDeadlines());
+
+    ASSERT_THROW(DeadlineScheduler(1, std::chrono::seconds(1), MissedDeadlinePolicy::Divert), NullPointerException);
+
+    //Plain schedule() calls, such as observeOn drains, run even past their budget.
+    auto tight = std::make_shared<DeadlineScheduler>(1, std::chrono::milliseconds(1));
+    auto tightWorker = tight->createWorker();
+    std::atomic<bool> ran(false);
+    tightWorker->schedule(std::make_shared<Action0>([](){
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }));
+    tightWorker->schedule(std::make_shared<Action0>([&](){
+        ran.store(true);
+    }));
+    for(int i = 0; i < 500 && !ran.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(ran.load());
+    ASSERT_EQ(0, tight->missedDeadlines());
+}
+
+TEST(RxCppTest, Serialize)
+{
+    const int threadsCount = 4;
+    const int perThread = 10000;
+    std::atomic<int> inside(0);
+    std::atomic<bool> overlapped(false);
+    int count = 0;
+    int completions = 0;
+
+    Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t)
+    {
+        std::vector<std::thread> threads;
+        for(int i = 0; i < threadsCount; ++i)
+        {
+            threads.push_back(std::thread([&t](){
+                for(int j = 0; j < perThread; ++j)
+                {
+                    t->onNext(j);
+                }
+            }));
+        }
+        for(auto& thread : threads)
+        {
+            thread.join();
+        }
+        t->onComplete();
+        t->onComplete();
+    }).serialize().subscribe([&](const int&){
+        if(++inside != 1)
+        {
+            overlapped.store(true);
+        }
+        ++count;
+        --inside;
+    }, [&](){
+        ++completions;
+    });
+
+    ASSERT_FALSE(overlapped.load());
+    ASSERT_EQ(threadsCount * perThread, count);
+    ASSERT_EQ(1, completions);
+}
+
+TEST(RxCppTest, FlatMap)
+{
+    std::vector<int> result;
+
+    Observable<>::just(1, 2, 3).flatMap([](const int& i){
+        return Observable<>::just(i * 10, i * 100);
+    }).subscribe([&](const int& i){
+        result.push_back(i);
+    });
+
+    ASSERT_EQ(std::vector<int>({10, 100, 20, 200, 30, 300}), result);
+}
+
+TEST(RxCppTest, FlatMapMaxConcurrency)
+{
+    auto pool = SchedulersFactory::instance().threadPoolScheduler();
+    std::atomic<int> subscribed(0);
+    std::atomic<int> maxSubscribed(0);
+    std::atomic<bool> complete(false);
+    std::atomic<int> inside(0);
+    std::atomic<bool> overlapped(false);
+    long long sum = 0;
+    int count = 0;
+
+    Observable<>::range(0, 200).flatMap([&](const int& i){
+        return Observable<int>::create([&, i](const Observable<int>::ThisSubscriberPtrType& t)
+        {
+            int now = ++subscribed;
+            int prev = maxSubscribed.load();
+            while(now > prev && !maxSubscribed.compare_exchange_weak(prev, now))
+            {}
+            for(int j = 0; j < 10; ++j)
+            {
+                t->onNext(i);
+            }
+            --subscribed;
+            t->onComplete();
+        }).subscribeOn(pool);
+    }, 3).subscribe([&](const int& i){
+        if(++inside != 1)
+        {
+            overlapped.store(true);
+        }
+        sum += i;
+        ++count;
+        --inside;
+    }, [&](){
+        complete.store(true);
+    });
+
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_TRUE(complete.load());
+    ASSERT_FALSE(overlapped.load());
+    ASSERT_LE(maxSubscribed.load(), 3);
+    ASSERT_EQ(2000, count);
+    ASSERT_EQ(10 * 199 * 200 / 2, sum);
+}
+
+TEST(RxCppTest, ConcatMapEager)
+{
+    auto pool = SchedulersFactory::instance().threadPoolScheduler();
+    std::atomic<int> subscribed(0);
+    std::atomic<int> maxSubscribed(0);
+    std::atomic<bool> complete(false);
+    std::vector<int> values;
+
+    Observable<>::range(0, 50).concatMapEager([&](const int& i){
+        return Observable<int>::create([&, i](const Observable<int>::ThisSubscriberPtrType& t)
+        {
+            int now = ++subscribed;
+            int prev = maxSubscribed.load();
+            while(now > prev && !maxSubscribed.compare_exchange_weak(prev, now))
+            {}
+            //Later inners finish first, the output stays in source order.
+            std::this_thread::sleep_for(std::chrono::microseconds((50 - i) * 20));
+            for(int j = 0; j < 4; ++j)
+            {
+                t->onNext(i * 4 + j);
+            }
+            --subscribed;
+            t->onComplete();
+        }).subscribeOn(pool);
+    }, 4).subscribe([&](const int& i){
+        values.push_back(i);
+    }, [&](){
+        complete.store(true);
+    });
+
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_TRUE(complete.load());
+    ASSERT_LE(maxSubscribed.load(), 4);
+    ASSERT_EQ(200u, values.size());
+    for(int i = 0; i < 200; ++i)
+    {
+        ASSERT_EQ(i, values[i]);
+    }
+}
+
+TEST(RxCppTest, SwitchMap)
+{
+    auto pool = SchedulersFactory::instance().threadPoolScheduler();
+    std::atomic<int> running(0);
+    std::atomic<bool> complete(false);
+    std::vector<int> values;
+
+    Observable<>::range(0, 5).switchMap([&](const int& i){
+        return Observable<int>::create([&, i](const Observable<int>::ThisSubscriberPtrType& t)
+        {
+            if(i == 4)
+            {
+                for(int j = 0; j < 3; ++j)
+                {
+                    t->onNext(i);
+                }
+                t->onComplete();
+                return;
+            }
+            //Superseded inners run until they are cancelled.
+            ++running;
+            while(!t->isUnsubscribe())
+            {
+                t->onNext(i);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            --running;
+        }).subscribeOn(pool);
+    }).subscribe([&](const int& i){
+        values.push_back(i);
+    }, [&](){
+        complete.store(true);
+    });
+
+    for(int i = 0; i < 500 && (!complete.load() || running.load() != 0); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_TRUE(complete.load());
+    ASSERT_EQ(0, running.load());
+    //Stale values are dropped after the serializer, so none can follow the last inner's.
+    auto first = std::find(values.begin(), values.end(), 4);
+    ASSERT_EQ(3, std::distance(first, values.end()));
+    ASSERT_EQ(3, std::count(values.begin(), values.end(), 4));
+
+    //A cancelled inner completing late does not hide the current inner's completion.
+    Observable<int>::ThisSubscriberPtrType upstream;
+    Observable<int>::ThisSubscriberPtrType stale;
+    std::vector<int> latest;
+    bool completed = false;
+    Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        upstream = t;
+    }).switchMap([&](const int& i){
+        if(i == 1)
+        {
+            return Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+                stale = t;
+            });
+        }
+        return Observable<>::just(i * 10);
+    }).subscribe([&](const int& i){
+        latest.push_back(i);
+    }, [&](){
+        completed = true;
+    });
+    upstream->onNext(1);
+    upstream->onNext(2);
+    stale->onComplete();
+    upstream->onComplete();
+    ASSERT_EQ(std::vector<int>({20}), latest);
+    ASSERT_TRUE(completed);
+}
+
+TEST(RxCppTest, SynchronousInnerFastPath)
+{
+    auto pool = SchedulersFactory::instance().threadPoolScheduler();
+    auto inner = Observable<>::range(0, 5).filter([](const int& i){
+        return i % 2 == 0;
+    }).map([](const int& i){
+        return i * 10;
+    });
+
+    ASSERT_TRUE(inner.isSynchronous());
+    ASSERT_TRUE(Observable<>::just(1).isSynchronous());
+    ASSERT_TRUE(Observable<>::just(1, 2, 3).isSynchronous());
+    ASSERT_FALSE(inner.subscribeOn(pool).isSynchronous());
+    ASSERT_FALSE(inner.take(1).isSynchronous());
+
+    std::vector<int> values;
+    bool complete = false;
+    Observable<>::just(1, 2).concatMap([&](const int& i){
+        return i == 1 ? inner : Observable<>::just(i).map([](const int& v){ return v + 100; });
+    }).subscribe([&](const int& i){
+        values.push_back(i);
+    }, [&](){
+        complete = true;
+    });
+    ASSERT_TRUE(complete);
+    ASSERT_EQ(std::vector<int>({0, 20, 40, 102}), values);
+
+    //Lifted operators keep their functions, the observable can be subscribed again.
+    values.clear();
+    Observable<>::range(0, 3).flatMap([&](const int&){
+        return inner;
+    }).subscribe([&](const int& i){
+        values.push_back(i);
+    });
+    ASSERT_EQ(9u, values.size());
+    ASSERT_EQ(180, std::accumulate(values.begin(), values.end(), 0));
+}
+
+TEST(RxCppTest, ParallelRails)
+{
+    auto pool = SchedulersFactory::instance().threadPoolScheduler();
+    std::atomic<bool> complete(false);
+    std::vector<int> ordered;
+
+    Observable<>::range(0, 1000).parallel(4, pool).map([](const int& i){
+        return i * 2;
+    }).filter([](const int& i){
+        return i % 3 != 0;
+    }).sequential(true).subscribe([&](const int& i){
+        ordered.push_back(i);
+    }, [&](){
+        complete.store(true);
+    });
+
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(complete.load());
+    ASSERT_EQ(666u, ordered.size());
+    ASSERT_TRUE(std::is_sorted(ordered.begin(), ordered.end()));
+    ASSERT_EQ(1996, ordered.back());
+
+    std::atomic<long long> sum(0);
+    std::atomic<int> count(0);
+    complete.store(false);
+    Observable<>::range(0, 1000).parallel(3, pool, [](const int& i){ return i % 10; }).map([](const int& i){
+        return i + 1;
+    }).sequential().subscribe([&](const int& i){
+        sum += i;
+        ++count;
+    }, [&](){
+        complete.store(true);
+    });
+
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(complete.load());
+    ASSERT_EQ(1000, count.load());
+    ASSERT_EQ(500500, sum.load());
+
+    std::atomic<int> reduced(0);
+    complete.store(false);
+    Observable<>::range(1, 100).parallel(4).reduce([](const int& a, const int& b){
+        return a + b;
+    }).subscribe([&](const int& v){
+        reduced.store(v);
+    }, [&](){
+        complete.store(true);
+    });
+
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(complete.load());
+    ASSERT_EQ(5050, reduced.load());
+}
+
+TEST(RxCppTest, MapAsync)
+{
+    auto pool = SchedulersFactory::instance().threadPoolScheduler();
+    std::atomic<int> inFlight(0);
+    std::atomic<int> maxInFlight(0);
+    std::atomic<bool> complete(false);
+    std::vector<int> values;
+
+    Observable<>::range(0, 100).mapAsync([&](const int& i){
+        int now = ++inFlight;
+        int prev = maxInFlight.load();
+        while(now > prev && !maxInFlight.compare_exchange_weak(prev, now))
+        {}
+        //Earlier values take longer, results still come out in order.
+        std::this_thread::sleep_for(std::chrono::microseconds((10 - i % 10) * 100));
+        --inFlight;
+        return i * i;
+    }, pool, 4).subscribe([&](const int& i){
+        values.push_back(i);
+    }, [&](){
+        complete.store(true);
+    });
+
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_TRUE(complete.load());
+    ASSERT_LE(maxInFlight.load(), 4);
+    ASSERT_GT(maxInFlight.load(), 1);
+    ASSERT_EQ(100u, values.size());
+    for(int i = 0; i < 100; ++i)
+    {
+        ASSERT_EQ(i * i, values[i]);
+    }
+
+    std::atomic<bool> failed(false);
+    Observable<>::range(0, 10).mapAsync([](const int& i){
+        if(i == 5)
+        {
+            throw std::runtime_error("mapper");
+        }
+        return i;
+    }, pool, 3).subscribe([](const int&){}, [&](std::exception_ptr){
+        failed.store(true);
+    }, [](){});
+
+    for(int i = 0; i < 500 && !failed.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(failed.load());
+}
+
+TEST(RxCppTest, Stage)
+{
+    auto stats = std::make_shared<StageStats>();
+    std::atomic<bool> complete(false);
+    std::atomic<bool> overflow(false);
+    std::vector<int> values;
+    std::thread::id producer = std::this_thread::get_id();
+    std::thread::id consumer;
+
+    Observable<>::range(0, 200).stage(SchedulersFactory::instance().newThread(), 8, stats).map([&](const int& i){
+        //Slow consumer: the producer has to wait on the full queue.
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        if(stats->occupancy.load() > 8)
+        {
+            overflow.store(true);
+        }
+        consumer = std::this_thread::get_id();
+        return i;
+    }).subscribe([&](const int& i){
+        values.push_back(i);
+    }, [&](){
+        complete.store(true);
+    });
+
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_TRUE(complete.load());
+    ASSERT_FALSE(overflow.load());
+    ASSERT_NE(producer, consumer);
+    ASSERT_EQ(200u, values.size());
+    ASSERT_TRUE(std::is_sorted(values.begin(), values.end()));
+    ASSERT_EQ(200u, stats->values.load());
+    ASSERT_EQ(8u, stats->maxOccupancy.load());
+    ASSERT_GT(stats->blockedTime().count(), 0);
+    ASSERT_GT(stats->utilization(), 0.0);
+
+    //A capacity that is not a power of two is still the exact bound.
+    auto exact = std::make_shared<StageStats>();
+    complete.store(false);
+    Observable<>::range(0, 50).stage(SchedulersFactory::instance().newThread(), 5, exact).map([](const int& i){
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        return i;
+    }).subscribe([](const int&){}, [&](){
+        complete.store(true);
+    });
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(complete.load());
+    ASSERT_EQ(5u, exact->maxOccupancy.load());
+}
+
+TEST(RxCppTest, ObserveOnBatched)
+{
+    auto pool = SchedulersFactory::instance().threadPoolScheduler();
+    std::atomic<bool> complete(false);
+    std::vector<int> values;
+    std::set<std::thread::id> threads;
+
+    Observable<>::range(0, 10000).observeOn(pool, 64, std::chrono::microseconds(100)).subscribe([&](const int& i){
+        values.push_back(i);
+        threads.insert(std::this_thread::get_id());
+    }, [&](){
+        complete.store(true);
+    });
+
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(complete.load());
+    ASSERT_EQ(10000u, values.size());
+    ASSERT_TRUE(std::is_sorted(values.begin(), values.end()));
+    ASSERT_EQ(0u, threads.count(std::this_thread::get_id()));
+
+    //A partial batch is flushed by the linger timer, not by completion.
+    std::atomic<int> received(0);
+    Observable<int>::ThisSubscriberPtrType subject;
+    Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        subject = t;
+    }).observeOn(pool, 64, std::chrono::milliseconds(1)).subscribe([&](const int&){
+        ++received;
+    });
+    subject->onNext(1);
+    subject->onNext(2);
+    for(int i = 0; i < 500 && received.load() != 2; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(2, received.load());
+
+    //A slow observer run by a linger flush does not hold up the producer.
+    std::atomic<bool> observing(false);
+    std::atomic<bool> release(false);
+    std::atomic<bool> stalled(false);
+    std::atomic<int> seen(0);
+    Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        subject = t;
+    }).observeOn(pool, 64, std::chrono::milliseconds(1)).subscribe([&](const int&){
+        observing.store(true);
+        for(int i = 0; i < 100 && !release.load(); ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if(!release.load())
+        {
+            stalled.store(true);
+        }
+        ++seen;
+    });
+    subject->onNext(1);
+    for(int i = 0; i < 500 && !observing.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(observing.load());
+    subject->onNext(2);
+    release.store(true);
+    for(int i = 0; i < 500 && seen.load() != 2; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(2, seen.load());
+    ASSERT_FALSE(stalled.load());
+}
+
+TEST(RxCppTest, TimerCancellation)
+{
+    TimerQueue timer;
+    auto owned = std::make_shared<int>(0);
+    std::vector<SubscriptionPtrType> handles;
+    for(int i = 0; i < 1000; ++i)
+    {
+        handles.push_back(timer.schedule(std::make_shared<Action0>([owned](){}),
+                                         TimerQueue::Clock::now() + std::chrono::hours(1)));
+    }
+    ASSERT_EQ(1000u, timer.size());
+    for(auto& handle : handles)
+    {
+        handle->unsubscribe();
+    }
+    //Cancelled actions are released at once, not when they fall due.
+    ASSERT_EQ(0u, timer.size());
+    ASSERT_EQ(1, owned.use_count());
+
+    std::atomic<bool> ran(false);
+    timer.schedule(std::make_shared<Action0>([&](){
+        ran.store(true);
+    }), TimerQueue::Clock::now());
+    for(int i = 0; i < 500 && !ran.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(ran.load());
+
+    //Unsubscribing a delayed or periodic action takes it off the shared timer.
+    auto worker = SchedulersFactory::instance().threadPoolScheduler()->createWorker();
+    auto delayed = worker->scheduleDelayed(std::make_shared<Action0>([owned](){}), std::chrono::hours(1));
+    auto periodic = worker->schedulePeriodically(std::make_shared<Action0>([owned](){}),
+                                                 std::chrono::hours(1), std::chrono::hours(1));
+    ASSERT_EQ(3, owned.use_count());
+    delayed->unsubscribe();
+    periodic->unsubscribe();
+    delayed.reset();
+    periodic.reset();
+    ASSERT_EQ(1, owned.use_count());
+}
+
+TEST(RxCppTest, BufferAndWindow)
+{
+    std::vector<std::vector<int>> chunks;
+    Observable<>::range(0, 7).buffer(3).subscribe([&](const std::vector<int>& v){
+        chunks.push_back(v);
+    });
+    ASSERT_EQ(std::vector<std::vector<int>>({{0, 1, 2}, {3, 4, 5}, {6}}), chunks);
+
+    chunks.clear();
+    Observable<>::range(0, 5).buffer(3, 1).subscribe([&](const std::vector<int>& v){
+        chunks.push_back(v);
+    });
+    ASSERT_EQ(std::vector<std::vector<int>>({{0, 1, 2}, {1, 2, 3}, {2, 3, 4}, {3, 4}, {4}}), chunks);
+
+    chunks.clear();
+    Observable<>::range(0, 7).buffer(2, 3).subscribe([&](const std::vector<int>& v){
+        chunks.push_back(v);
+    });
+    ASSERT_EQ(std::vector<std::vector<int>>({{0, 1}, {3, 4}, {6}}), chunks);
+
+    std::vector<std::vector<std::string>> lines;
+    std::vector<std::string> words = {"a", "bb", "ccc", "dddd", "e", "ffffffffff"};
+    Observable<>::from(words).bufferBySize(5, [](const std::string& s){
+        return s.size();
+    }).subscribe([&](const std::vector<std::string>& v){
+        lines.push_back(v);
+    });
+    ASSERT_EQ(std::vector<std::vector<std::string>>({{"a", "bb"}, {"ccc"}, {"dddd", "e"}, {"ffffffffff"}}), lines);
+
+    std::vector<int> sums;
+    bool complete = false;
+    Observable<>::range(1, 10).window(4).subscribe([&](const Observable<int>& w){
+        sums.push_back(0);
+        Observable<int> window(w);
+        window.subscribe([&](const int& i){
+            sums.back() += i;
+        });
+    }, [&](){
+        complete = true;
+    });
+    ASSERT_TRUE(complete);
+    ASSERT_EQ(std::vector<int>({10, 26, 19}), sums);
+}
+
+TEST(RxCppTest, BufferAndWindowWithTime)
+{
+    std::mutex lock;
+    std::vector<std::vector<int>> chunks;
+    Observable<int>::ThisSubscriberPtrType subject;
+    Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        subject = t;
+    }).buffer(std::chrono::milliseconds(20), 3).subscribe([&](const std::vector<int>& v){
+        std::lock_guard<std::mutex> l(lock);
+        chunks.push_back(v);
+    });
+
+    //Count closes the first vector, the timer the second.
+    for(int i = 0; i < 5; ++i)
+    {
+        subject->onNext(i);
+    }
+    for(int i = 0; i < 500; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::lock_guard<std::mutex> l(lock);
+        if(chunks.size() == 2)
+        {
+            break;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> l(lock);
+        ASSERT_EQ(std::vector<std::vector<int>>({{0, 1, 2}, {3, 4}}), chunks);
+    }
+    subject->onNext(5);
+    subject->onComplete();
+    ASSERT_EQ(std::vector<std::vector<int>>({{0, 1, 2}, {3, 4}, {5}}), chunks);
+
+    std::atomic<int> windows(0);
+    std::atomic<int> closed(0);
+    std::atomic<int> sum(0);
+    Observable<int>::ThisSubscriberPtrType source;
+    Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        source = t;
+    }).window(std::chrono::milliseconds(10)).subscribe([&](const Observable<int>& w){
+        ++windows;
+        Observable<int> window(w);
+        window.subscribe([&](const int& i){
+            sum += i;
+        }, [&](){
+            ++closed;
+        });
+    });
+    source->onNext(1);
+    source->onNext(2);
+    for(int i = 0; i < 500 && closed.load() != 1; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(1, closed.load());
+    source->onNext(3);
+    source->onComplete();
+    ASSERT_EQ(2, windows.load());
+    ASSERT_EQ(2, closed.load());
+    ASSERT_EQ(6, sum.load());
+
+    //Buffers closed by count take their timers off the shared timer.
+    size_t timers = TimerQueue::instance().size();
+    size_t buffers = 0;
+    Observable<>::range(0, 1000).buffer(std::chrono::seconds(60), 2).subscribe([&](const std::vector<int>&){
+        ++buffers;
+    });
+    ASSERT_EQ(500u, buffers);
+    ASSERT_LE(TimerQueue::instance().size(), timers);
+}
+
+TEST(RxCppTest, RateShaping)
+{
+    auto scheduler = std::make_shared<TestScheduler>();
+    Observable<int>::ThisSubscriberPtrType subject;
+    auto source = Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        subject = t;
+    });
+
+    std::vector<int> first;
+    source.throttleFirst(std::chrono::milliseconds(10), scheduler).subscribe([&](const int& i){
+        first.push_back(i);
+    });
+    subject->onNext(1);
+    scheduler->advanceBy(std::chrono::milliseconds(5));
+    subject->onNext(2);
+    scheduler->advanceBy(std::chrono::milliseconds(5));
+    subject->onNext(3);
+    subject->onNext(4);
+    ASSERT_EQ(std::vector<int>({1, 3}), first);
+
+    std::vector<int> sampled;
+    bool complete = false;
+    source.sample(std::chrono::milliseconds(10), scheduler).subscribe([&](const int& i){
+        sampled.push_back(i);
+    }, [&](){
+        complete = true;
+    });
+    subject->onNext(1);
+    subject->onNext(2);
+    scheduler->advanceBy(std::chrono::milliseconds(10));
+    scheduler->advanceBy(std::chrono::milliseconds(10));
+    subject->onNext(3);
+    scheduler->advanceBy(std::chrono::milliseconds(10));
+    ASSERT_EQ(std::vector<int>({2, 3}), sampled);
+    subject->onComplete();
+    ASSERT_TRUE(complete);
+    scheduler->advanceBy(std::chrono::milliseconds(100));
+    ASSERT_EQ(0u, scheduler->pending());
+
+    std::vector<int> debounced;
+    source.debounce(std::chrono::milliseconds(10), scheduler).subscribe([&](const int& i){
+        debounced.push_back(i);
+    });
+    subject->onNext(1);
+    scheduler->advanceBy(std::chrono::milliseconds(5));
+    subject->onNext(2);
+    scheduler->advanceBy(std::chrono::milliseconds(9));
+    ASSERT_TRUE(debounced.empty());
+    scheduler->advanceBy(std::chrono::milliseconds(1));
+    ASSERT_EQ(std::vector<int>({2}), debounced);
+    subject->onNext(3);
+    subject->onComplete();
+    ASSERT_EQ(std::vector<int>({2, 3}), debounced);
+
+    //Completion takes the pending quiet timer off the shared timer.
+    size_t timers = TimerQueue::instance().size();
+    int last = 0;
+    for(int i = 0; i < 1000; ++i)
+    {
+        Observable<>::just(i).debounce(std::chrono::seconds(60)).subscribe([&](const int& v){
+            last = v;
+        });
+    }
+    ASSERT_EQ(999, last);
+    ASSERT_LE(TimerQueue::instance().size(), timers);
+}
+
+TEST(RxCppTest, TimeoutAndRetry)
+{
+    auto scheduler = std::make_shared<TestScheduler>();
+    Observable<int>::ThisSubscriberPtrType subject;
+    auto source = Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        subject = t;
+    });
+
+    std::vector<int> values;
+    bool timedOut = false;
+    source.timeout(std::chrono::milliseconds(10), scheduler).subscribe([&](const int& i){
+        values.push_back(i);
+    }, [&](std::exception_ptr ex){
+        try
+        {
+            std::rethrow_exception(ex);
+        }
+        catch(const TimeoutException&)
+        {
+            timedOut = true;
+        }
+    });
+    scheduler->advanceBy(std::chrono::milliseconds(8));
+    subject->onNext(1);
+    scheduler->advanceBy(std::chrono::milliseconds(8));
+    subject->onNext(2);
+    scheduler->advanceBy(std::chrono::milliseconds(9));
+    ASSERT_FALSE(timedOut);
+    scheduler->advanceBy(std::chrono::milliseconds(1));
+    ASSERT_TRUE(timedOut);
+    subject->onNext(3);
+    ASSERT_EQ(std::vector<int>({1, 2}), values);
+
+    values.clear();
+    bool complete = false;
+    source.timeout(std::chrono::milliseconds(10), Observable<>::just(7, 8), scheduler).subscribe([&](const int& i){
+        values.push_back(i);
+    }, [&](){
+        complete = true;
+    });
+    subject->onNext(1);
+    scheduler->advanceBy(std::chrono::milliseconds(10));
+    ASSERT_TRUE(complete);
+    ASSERT_EQ(std::vector<int>({1, 7, 8}), values);
+
+    //Fails twice, then succeeds on the third subscription after 10 + 20 ms.
+    int subscriptions = 0;
+    values.clear();
+    complete = false;
+    Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        t->onNext(subscriptions);
+        if(++subscriptions < 3)
+        {
+            t->onError(std::make_exception_ptr(some_exception(subscriptions)));
+            return;
+        }
+        t->onComplete();
+    }).retry(5, std::chrono::milliseconds(10), 2.0, 0.0, scheduler).subscribe([&](const int& i){
+        values.push_back(i);
+    }, [&](){
+        complete = true;
+    });
+    ASSERT_EQ(1, subscriptions);
+    scheduler->advanceBy(std::chrono::milliseconds(10));
+    ASSERT_EQ(2, subscriptions);
+    scheduler->advanceBy(std::chrono::milliseconds(19));
+    ASSERT_EQ(2, subscriptions);
+    scheduler->advanceBy(std::chrono::milliseconds(1));
+    ASSERT_TRUE(complete);
+    ASSERT_EQ(std::vector<int>({0, 1, 2}), values);
+
+    int errorCode = 0;
+    Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        t->onError(std::make_exception_ptr(some_exception(42)));
+    }).retry(2, std::chrono::milliseconds(1), 1.0, 0.5, scheduler).subscribe([&](const int&){
+    }, [&](std::exception_ptr ex){
+        try
+        {
+            std::rethrow_exception(ex);
+        }
+        catch(const some_exception& e)
+        {
+            errorCode = e.v;
+        }
+    });
+    scheduler->advanceBy(std::chrono::milliseconds(10));
+    ASSERT_EQ(42, errorCode);
+
+    //Completed and unsubscribed timeouts take their timers off the shared timer.
+    size_t timers = TimerQueue::instance().size();
+    int sum = 0;
+    for(int i = 0; i < 10000; ++i)
+    {
+        Observable<>::just(1).timeout(std::chrono::seconds(60)).subscribe([&](const int& v){
+            sum += v;
+        });
+    }
+    ASSERT_EQ(10000, sum);
+    ASSERT_LE(TimerQueue::instance().size(), timers);
+
+    auto subscription = source.timeout(std::chrono::seconds(60)).subscribe([&](const int&){});
+    subscription->unsubscribe();
+    ASSERT_LE(TimerQueue::instance().size(), timers);
+}
+
+TEST(RxCppTest, AmbAndHedge)
+{
+    std::vector<int> values;
+    bool complete = false;
+    Observable<>::amb(Observable<>::range(10, 3), Observable<>::range(20, 3)).subscribe([&](const int& i){
+        values.push_back(i);
+    }, [&](){
+        complete = true;
+    });
+    ASSERT_TRUE(complete);
+    ASSERT_EQ(std::vector<int>({10, 11, 12}), values);
+
+    //The second source answers first, the first one is unsubscribed.
+    Observable<int>::ThisSubscriberPtrType slow;
+    Observable<int>::ThisSubscriberPtrType fast;
+    values.clear();
+    Observable<>::amb(Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        slow = t;
+    }), Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        fast = t;
+    })).subscribe([&](const int& i){
+        values.push_back(i);
+    });
+    fast->onNext(2);
+    ASSERT_TRUE(slow->isUnsubscribe());
+    slow->onNext(1);
+    fast->onNext(3);
+    ASSERT_EQ(std::vector<int>({2, 3}), values);
+
+    //The duplicate is only subscribed after the delay, and wins when it answers first.
+    auto scheduler = std::make_shared<TestScheduler>();
+    std::vector<Observable<int>::ThisSubscriberPtrType> attempts;
+    auto request = Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        attempts.push_back(t);
+    });
+    values.clear();
+    Observable<>::hedge(request, std::chrono::milliseconds(5), 1, scheduler).subscribe([&](const int& i){
+        values.push_back(i);
+    });
+    ASSERT_EQ(1u, attempts.size());
+    scheduler->advanceBy(std::chrono::milliseconds(5));
+    ASSERT_EQ(2u, attempts.size());
+    attempts[1]->onNext(7);
+    ASSERT_TRUE(attempts[0]->isUnsubscribe());
+    ASSERT_EQ(std::vector<int>({7}), values);
+
+    attempts.clear();
+    values.clear();
+    Observable<>::hedge(request, std::chrono::milliseconds(5), 1, scheduler).subscribe([&](const int& i){
+        values.push_back(i);
+    });
+    attempts[0]->onNext(1);
+    scheduler->advanceBy(std::chrono::milliseconds(10));
+    ASSERT_EQ(1u, attempts.size());
+    ASSERT_EQ(std::vector<int>({1}), values);
+}
+
+TEST(RxCppTest, ZipAndCombineLatest)
+{
+    std::vector<std::tuple<int, std::string>> pairs;
+    Observable<>::zip(Observable<>::range(0, 5), Observable<>::just(std::string("a"), std::string("b"), std::string("c")))
+            .subscribe([&](const std::tuple<int, std::string>& p){
+        pairs.push_back(p);
+    });
+    ASSERT_EQ(3u, pairs.size());
+    ASSERT_EQ(2, std::get<0>(pairs[2]));
+    ASSERT_EQ("c", std::get<1>(pairs[2]));
+
+    //Sources on different pools, combined without a shared lock.
+    auto pool = SchedulersFactory::instance().threadPoolScheduler();
+    auto other = SchedulersFactory::instance().newThread();
+    std::atomic<bool> complete(false);
+    std::vector<int> sums;
+    Observable<>::zip([](const int& a, const int& b, const int& c){
+        return a + b + c;
+    }, Observable<>::range(0, 1000).subscribeOn(pool), Observable<>::range(0, 1000).subscribeOn(other),
+       Observable<>::range(0, 1000)).subscribe([&](const int& sum){
+        sums.push_back(sum);
+    }, [&](){
+        complete.store(true);
+    });
+    for(int i = 0; i < 500 && !complete.load(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(complete.load());
+    ASSERT_EQ(1000u, sums.size());
+    ASSERT_EQ(3 * 999, sums.back());
+
+    Observable<int>::ThisSubscriberPtrType left;
+    Observable<int>::ThisSubscriberPtrType right;
+    std::vector<int> latest;
+    bool done = false;
+    Observable<>::combineLatest([](const int& a, const int& b){
+        return a * 10 + b;
+    }, Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        left = t;
+    }), Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        right = t;
+    })).subscribe([&](const int& i){
+        latest.push_back(i);
+    }, [&](){
+        done = true;
+    });
+    left->onNext(1);
+    left->onNext(2);
+    right->onNext(5);
+    left->onNext(3);
+    left->onComplete();
+    right->onNext(6);
+    ASSERT_FALSE(done);
+    right->onComplete();
+    ASSERT_TRUE(done);
+    ASSERT_EQ(std::vector<int>({25, 35, 36}), latest);
+
+    //Values queued while the drain is busy are combined in arrival order.
+    latest.clear();
+    Observable<>::combineLatest([](const int& a, const int& b){
+        return a * 10 + b;
+    }, Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        left = t;
+    }), Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        right = t;
+    })).subscribe([&](const int& i){
+        latest.push_back(i);
+        if(i == 25)
+        {
+            left->onNext(3);
+            right->onNext(6);
+        }
+    });
+    left->onNext(1);
+    right->onNext(5);
+    left->onNext(2);
+    ASSERT_EQ(std::vector<int>({15, 25, 35, 36}), latest);
+
+    //A source running ahead of the others by more than the bound fails the zip.
+    bool slow = false;
+    pairs.clear();
+    Observable<>::zip(16, MakeTuple(), Observable<>::range(0, 100), Observable<>::just(std::string("a")))
+            .subscribe([&](const std::tuple<int, std::string>& p){
+        pairs.push_back(p);
+    }, [&](std::exception_ptr ex){
+        try
+        {
+            std::rethrow_exception(ex);
+        }
+        catch(const SlowSubscriberException&)
+        {
+            slow = true;
+        }
+    });
+    ASSERT_TRUE(slow);
+    ASSERT_TRUE(pairs.empty());
+
+    //Without a bound, long synchronous sources are zipped whole.
+    size_t zipped = 0;
+    bool zipComplete = false;
+    Observable<>::zip(Observable<>::range(0, 10000), Observable<>::range(0, 10000)).subscribe(
+                [&](const std::tuple<int, int>& p){
+        ASSERT_EQ(std::get<0>(p), std::get<1>(p));
+        ++zipped;
+    }, [&](){
+        zipComplete = true;
+    });
+    ASSERT_TRUE(zipComplete);
+    ASSERT_EQ(10000u, zipped);
+}
+
+TEST(RxCppTest, GroupBy)
+{
+    std::map<int, int> sums;
+    std::vector<int> keys;
+    Observable<>::range(0, 10).groupBy([](const int& i){
+        return i % 3;
+    }).subscribe([&](const GroupedObservable<int, int>& group){
+        int key = group.getKey();
+        keys.push_back(key);
+        Observable<int> values(group);
+        values.subscribe([&sums, key](const int& i){
+            sums[key] += i;
+        });
+    });
+    ASSERT_EQ(std::vector<int>({0, 1, 2}), keys);
+    ASSERT_EQ(0 + 3 + 6 + 9, sums[0]);
+    ASSERT_EQ(1 + 4 + 7, sums[1]);
+    ASSERT_EQ(2 + 5 + 8, sums[2]);
+
+    //Pinned groups: each key is processed on a single thread, in order.
+    auto lanes = std::make_shared<PartitionedScheduler>(4);
+    std::mutex lock;
+    std::map<int, std::set<std::thread::id>> threads;
+    std::map<int, std::vector<int>> values;
+    std::atomic<int> completed(0);
+    Observable<>::range(0, 4000).groupBy([](const int& i){
+        return i % 8;
+    }, lanes).subscribe([&](const GroupedObservable<int, int>& group){
+        int key = group.getKey();
+        Observable<int> groupValues(group);
+        groupValues.subscribe([&, key](const int& i){
+            std::lock_guard<std::mutex> l(lock);
+            threads[key].insert(std::this_thread::get_id());
+            values[key].push_back(i);
+        }, [&](){
+            ++completed;
+        });
+    });
+    for(int i = 0; i < 500 && completed.load() != 8; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(8, completed.load());
+    for(int key = 0; key < 8; ++key)
+    {
+        ASSERT_EQ(1u, threads[key].size());
+        ASSERT_EQ(500u, values[key].size());
+        ASSERT_TRUE(std::is_sorted(values[key].begin(), values[key].end()));
+    }
+
+    //Without an idle timeout no clock worker is created.
+    struct CountingScheduler : public PartitionedScheduler
+    {
+        CountingScheduler() : PartitionedScheduler(2), created(0)
+        {}
+
+        WorkerRefType createWorker() override
+        {
+            ++created;
+            return PartitionedScheduler::createWorker();
+        }
+
+        std::atomic<int> created;
+    };
+    auto counting = std::make_shared<CountingScheduler>();
+    Observable<>::range(0, 10).groupBy([](const int& i){
+        return i % 2;
+    }, counting).subscribe([](const GroupedObservable<int, int>&){});
+    ASSERT_EQ(0, counting->created.load());
+
+    //Idle groups are completed and reopened on their next value.
+    auto scheduler = std::make_shared<TestScheduler>();
+    Observable<int>::ThisSubscriberPtrType subject;
+    std::vector<int> opened;
+    int closed = 0;
+    Observable<int>::create([&](const Observable<int>::ThisSubscriberPtrType& t){
+        subject = t;
+    }).groupBy([](const int& i){
+        return i % 2;
+    }, scheduler, std::chrono::milliseconds(10)).subscribe([&](const GroupedObservable<int, int>& group){
+        opened.push_back(group.getKey());
+        Observable<int> groupValues(group);
+        groupValues.subscribe([](const int&){}, [&](){
+            ++closed;
+        });
+    });
+    subject->onNext(1);
+    scheduler->advanceBy(std::chrono::milliseconds(15));
+    subject->onNext(2);
+    scheduler->advanceBy(std::chrono::milliseconds(15));
+    subject->onNext(4);
+    scheduler->triggerActions();
+    ASSERT_EQ(1, closed);
+    subject->onNext(3);
+    ASSERT_EQ(std::vector<int>({1, 0, 1}), opened);
+}
+
+TEST(RxCppTest, ConcurrentToMapAndReduce)
+{
+    //Four threads emit at once, no synchronize() in between.
+    auto source = Observable<int>::create([](const Observable<int>::ThisSubscriberPtrType& t){
+        std::vector<std::thread> threads;
+        for(int n = 0; n < 4; ++n)
+        {
+            threads.emplace_back([t](){
+                for(int i = 0; i < 10000; ++i)
+                {
+                    t->onNext(i);
+                }
+            });
+        }
+        for(auto& thread : threads)
+        {
+            thread.join();
+        }
+        t->onComplete();
+    });
+
+    std::map<int, int> counts;
+    source.toMapConcurrent([](const int& i){
+        return i % 10;
+    }, [](const int&){
+        return 0;
+    }, [](const int&, const int& prev){
+        return prev + 1;
+    }, [](const int& a, const int& b){
+        return a + b;
+    }).subscribe([&](const std::map<int, int>& m){
+        counts = m;
+    });
+    ASSERT_EQ(10u, counts.size());
+    for(auto& entry : counts)
+    {
+        ASSERT_EQ(4000, entry.second);
+    }
+
+    long long sum = 0;
+    Observable<long long>::create([&](const Observable<long long>::ThisSubscriberPtrType& t){
+        source.subscribe([t](const int& i){
+            t->onNext(i);
+        }, [t](){
+            t->onComplete();
+        });
+    }).reduceConcurrent([](const long long& a, const long long& b){
+        return a + b;
+    }).subscribe([&](const long long& s){
+        sum = s;
+    });
+    ASSERT_EQ(4LL * 9999 * 10000 / 2, sum);
+
+    std::map<int, int> collected;
+    auto pool = SchedulersFactory::instance().threadPoolScheduler();
+    bool complete = false;
+    std::mutex lock;
+    std::condition_variable cond;
+    Observable<>::range(0, 10000).parallel(4, pool).collect([](){
+        return std::map<int, int>();
+    }, [](std::map<int, int>& m, const int& i){
+        ++m[i % 7];
+    }, [](std::map<int, int>& into, const std::map<int, int>& from){
+        for(auto& entry : from)
+        {
+            into[entry.first] += entry.second;
+        }
+    }).subscribe([&](const std::map<int, int>& m){
+        collected = m;
+    }, [&](){
+        std::lock_guard<std::mutex> l(lock);
+        complete = true;
+        cond.notify_one();
+    });
+    std::unique_lock<std::mutex> l(lock);
+    ASSERT_TRUE(cond.wait_for(l, std::chrono::seconds(5), [&](){ return complete; }));
+    ASSERT_EQ(7u, collected.size());
+    ASSERT_EQ(1429, collected[0]);
+    ASSERT_EQ(1428, collected[6]);
+    l.unlock();
+
+    //More live aggregations than the thread cache holds still get one partial each.
+    std::vector<std::unique_ptr<ThreadLocalPartials<int>>> aggregations;
+    for(int n = 0; n < 20; ++n)
+    {
+        aggregations.emplace_back(new ThreadLocalPartials<int>());
+    }
+    for(int round = 0; round < 3; ++round)
+    {
+        for(auto& aggregation : aggregations)
+        {
+            ++aggregation->local();
+        }
+    }
+    for(auto& aggregation : aggregations)
+    {
+        size_t count = 0;
+        aggregation->forEach([&](const int& partial){
+            ++count;
+            ASSERT_EQ(3, partial);
+        });
+        ASSERT_EQ(1u, count);
+    }
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
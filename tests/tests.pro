@@ -51,4 +51,42 @@ HEADERS += \
     ../src/Subscription.hpp \
     ../src/operators/OperatorTakeWhile.hpp \
     ../src/operators/OperatorSynchronize.hpp \
-    ../src/exceptions/TRExceptions.hpp
+    ../src/exceptions/TRExceptions.hpp \
+    ../src/schedulers/PartitionedScheduler.hpp \
+    ../src/operators/OperatorObserveOnPartitioned.hpp \
+    ../src/utils/PriorityMTQueue.hpp \
+    ../src/utils/DeadlineExecutor.hpp \
+    ../src/schedulers/DeadlineScheduler.hpp \
+    ../src/utils/MPSCQueue.hpp \
+    ../src/operators/OperatorSerialize.hpp \
+    ../src/operators/OnSubscribeConcatMapEager.hpp \
+    ../src/operators/OnSubscribeSwitchMap.hpp \
+    ../src/operators/JustOnSubscribe.hpp \
+    ../src/operators/FromListOnSubscribe.hpp \
+    ../src/operators/OnSubscribeParallel.hpp \
+    ../src/ParallelObservable.hpp \
+    ../src/operators/OperatorMapAsync.hpp \
+    ../src/utils/SPSCQueue.hpp \
+    ../src/operators/OperatorStage.hpp \
+    ../src/utils/TimerQueue.hpp \
+    ../src/operators/OperatorObserveOnBatched.hpp \
+    ../src/operators/OperatorBuffer.hpp \
+    ../src/operators/UnicastOnSubscribe.hpp \
+    ../src/operators/OperatorWindow.hpp \
+    ../src/schedulers/TestScheduler.hpp \
+    ../src/operators/OperatorThrottleFirst.hpp \
+    ../src/operators/OperatorSample.hpp \
+    ../src/operators/OperatorDebounce.hpp \
+    ../src/operators/OnSubscribeTimeout.hpp \
+    ../src/operators/OnSubscribeRetry.hpp \
+    ../src/operators/OnSubscribeAmb.hpp \
+    ../src/operators/OnSubscribeZip.hpp \
+    ../src/operators/OnSubscribeCombineLatest.hpp \
+    ../src/utils/OpenAddressingMap.hpp \
+    ../src/operators/OperatorGroupBy.hpp \
+    ../src/GroupedObservable.hpp \
+    ../src/utils/ThreadLocalPartials.hpp \
+    ../src/operators/OperatorReduceConcurrent.hpp \
+    ../src/utils/MapUtil.hpp \
+    ../src/utils/MaterializedView.hpp \
+    ../src/operators/OperatorToMapIncremental.hpp